@@ -0,0 +1,35 @@
+#ifndef CIC_DECIMATOR_H
+#define CIC_DECIMATOR_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Decimador CIC en punto fijo (orden 1 = media por bloques, "box").
+//
+// order integradores a la tasa de entrada, factor muestras por salida y
+// order diferenciadores a la tasa de salida; la salida se divide por la
+// ganancia factor^order con redondeo, así que queda en las mismas unidades
+// que la entrada. Todo en enteros de 64 bits sin signo: el desbordamiento
+// de los integradores es modular y se cancela en los diferenciadores
+// (exacto mientras |entrada| * factor^order quepa en 63 bits: 24 bits de
+// entrada admiten factor^order hasta 2^39).
+//
+// Las primeras order salidas llevan historia a cero y se descartan.
+
+struct CicDecimator {
+  int order;
+  int factor;
+  int phase;                             // Entradas desde la última salida
+  int warmup;                            // Salidas que quedan por descartar
+  uint64_t gain;
+  uint64_t integrators[CIC_MAX_ORDER];
+  uint64_t combs[CIC_MAX_ORDER];         // Entrada anterior de cada diferenciador
+};
+
+// false si order o factor están fuera de rango
+bool cicIniciar(CicDecimator* cic, int order, int factor);
+
+// true cuando hay salida nueva en *out
+bool cicAgregar(CicDecimator* cic, int32_t sample, int32_t* out);
+
+#endif
@@ -8,6 +8,7 @@
 #include <DallasTemperature.h>
 #include <Adafruit_NeoPixel.h>
 #include "config.h"
+#include "pulse_pattern.h"
 
 // Enumeraciones
 enum SystemMode {
@@ -18,35 +19,7 @@ enum SystemMode {
   MODE_WIFI_SCAN
 };
 
-enum TestCase {
-  TEST_CASE_1,
-  TEST_CASE_2,
-  TEST_CASE_3,
-  TEST_CASE_4,
-  TEST_CASE_5
-};
-
-enum PhaseType {
-  PHASE_TRANSITION,  // Cambio progresivo de tempo
-  PHASE_STABLE       // Tempo constante
-};
-
 // Estructuras
-struct PulsePhase {
-  PhaseType type;
-  float tempo_start_ms;   // Tiempo entre pulsos al inicio (ms)
-  float tempo_end_ms;     // Tiempo entre pulsos al final (ms)
-  int num_pulses;         // Número de pulsos a generar en esta fase
-  float jitter_percent;   // % de variación aleatoria
-};
-
-struct PulsePattern {
-  float periods[MAX_PULSES];
-  int count;
-  float frequencies[GRAPH_WIDTH];
-  int freq_count;
-};
-
 struct WiFiNetwork {
   String ssid;
   int32_t rssi;
@@ -78,6 +51,9 @@ extern float graph_data[GRAPH_WIDTH];
 extern int graph_index;
 extern float max_freq_scale;
 
+// Variables globales - Estadística
+extern uint32_t quantile_window_ms;  // Ventana de los cuantiles de READ y PRESSURE (0 = desde el inicio)
+
 // Melodías Mario Bros
 extern int mario_melody[];
 extern int mario_durations[];
@@ -11,6 +11,55 @@
 #define I2C_SCL 22
 #define WNK1MA_ADDR 0x6D
 #define WNK1MA_CMD 0x06
+#define I2C_CLOCK_HZ 100000
+#define I2C_FAST_CLOCK_HZ 400000        // Modo ráfaga de PRESSURE
+#define WNK1MA_CONVERSION_US 300        // Entre la orden de conversión y la lectura
+#define WNK1MA_I2C_TIMEOUT_MS 2         // Tope de una transacción (Wire usa 50 ms por defecto)
+#define WNK1MA_MAX_RETRIES 2            // Reintentos por lectura antes de recuperar el bus
+#define WNK1MA_RETRY_DELAY_US 1000      // Pausa antes de repetir una lectura fallida
+
+// Muestreo de presión en tarea propia (ritmo: PRESSURE_READ_INTERVAL_MS)
+#define PRESSURE_SAMPLER_TIMER 1        // Timer hardware (el 0 es del generador)
+#define PRESSURE_SAMPLER_CORE 0         // loop() y la pantalla corren en el núcleo 1
+#define PRESSURE_SAMPLER_PRIORITY 5
+#define PRESSURE_SAMPLER_STACK 3072
+#define PRESSURE_SAMPLE_RING_SIZE 64    // Salidas a tasa de pantalla en cola (potencia de 2): 640 ms a 100 Hz
+#define PRESSURE_RAW_RING_SIZE 1024     // Muestras a tasa completa en cola (potencia de 2): 0.5 s a 2 kHz
+
+// Modo ráfaga de PRESSURE: I2C a 400 kHz, conversión continua y decimador CIC
+#define PRESSURE_BURST_PERIOD_US 500    // 2 kHz: conversión (300 µs) + lectura y orden a 400 kHz
+#define PRESSURE_BURST_MIN_PERIOD_US 400
+#define PRESSURE_BURST_DECIMATION 20    // 2 kHz / 20 = 100 Hz en pantalla
+#define PRESSURE_BURST_CIC_ORDER 2
+#define CIC_MAX_ORDER 4
+#define CIC_MAX_DECIMATION 64
+#define PRESSURE_REPORT_INTERVAL_MS 1000  // Ventana de tasa, ruido y carga de CPU
+#define PRESSURE_EXPORT_MAX 2048        // Muestras a tasa completa por volcado
+
+// Calibración de presión (cuentas -> Pa), guardada en NVS
+#define PRESSURE_CAL_MAX_POINTS 16
+#define PRESSURE_CAL_MAX_SLOPE 16384    // Pa por cuenta como mucho en un tramo
+#define PRESSURE_CAL_MAX_RAW 0xFFFFFF   // Lectura más alta del sensor (24 bits)
+#define PRESSURE_CAL_NVS_NAMESPACE "pcal"
+
+// Autoescala de PRESSURE: mín./máx. de una ventana deslizante con histéresis
+#define SLIDING_EXTREMA_CAPACITY 256    // Entradas por cola monótona (>= GRAPH_WIDTH)
+#define SLIDING_EXTREMA_BLOCKS 64       // Bloques de una ventana por tiempo
+#define PRESSURE_SCALE_WINDOW_MS 0      // Ventana inicial (0 = lo visible: GRAPH_WIDTH muestras)
+#define PRESSURE_SCALE_WINDOW_MAX_MS 600000
+#define PRESSURE_SCALE_MARGIN 0.10f     // Holgura a cada lado al reescalar, sobre el rango
+#define PRESSURE_SCALE_SHRINK 0.5f      // Se encoge cuando los datos ocupan menos de esta fracción
+
+// Captura de transitorios de PRESSURE por disparo (tasa completa)
+#define PRESSURE_TRIGGER_PIN 33         // Pulso externo para el disparo por pulso (flanco de subida)
+#define PRESSURE_TRIGGER_PULSE_RING_SIZE 16  // Pulsos en cola (potencia de 2)
+#define PRESSURE_CAPTURE_SLOTS 4        // Capturas guardadas (se reutiliza la más vieja)
+#define PRESSURE_CAPTURE_MAX 512        // Muestras por captura: 256 ms a 2 kHz
+#define PRESSURE_TRIGGER_PRE_DEFAULT 100   // 50 ms antes del disparo a 2 kHz
+#define PRESSURE_TRIGGER_POST_DEFAULT 300  // 150 ms desde el disparo
+#define PRESSURE_TRIGGER_SLOPE_MAX 64   // Muestras de historia del disparo por salto
+#define PRESSURE_TRIGGER_RATE_SMOOTH 8  // Muestras de la media exponencial de dP/dt
+#define PRESSURE_CAPTURE_MAX_ZOOM 16
 
 // Recirculador
 #define TEMP_SENSOR_PIN 15
@@ -68,6 +117,91 @@
 
 // Constantes para generación de pulsos
 #define MAX_PULSES 1000
+#define PATTERN_PREVIEW_MAX_PULSES 16384  // Suma prefija de la vista previa (4 B/pulso, temporal)
+
+// Motor de reproducción por hardware (timer + anillo de períodos)
+#define PULSE_OUTPUT_TIMER 0            // Timer hardware usado por el motor (0-3)
+#define PULSE_OUTPUT_RING_SIZE 64       // Períodos en cola (potencia de 2)
+#define PULSE_HIGH_US 5000              // Duración del pulso HIGH
+#define PULSE_OUTPUT_START_DELAY_US 1000  // Margen antes del primer flanco
+#define PULSE_OUTPUT_UNDERRUN_RETRY_US 500  // Reintento si el anillo está vacío
+#define PULSE_OUTPUT_MIN_LEAD_US 20     // Flancos más cercanos se esperan dentro de la ISR
+#define PULSE_OUTPUT_MAX_CHANNELS 4     // Canales que puede planificar el motor
+#define PULSE_OUTPUT_CATCHUP_POLICY 0   // Recuperación de retrasos: 0 = emitir tarde, 1 = saltar, 2 = comprimir
+#define PULSE_OUTPUT_COMPRESS_MIN_PERCENT 50  // Período mínimo al comprimir (% del planificado)
+#define PULSE_OUTPUT_MIN_GAP_US 1000    // Separación mínima entre flancos de subida al recuperar
+
+// Canales del modo WRITE (canal 0 = SENSOR_PIN)
+#define WRITE_CHANNEL_COUNT 3
+#define WRITE_CHANNEL_PIN_1 25
+#define WRITE_CHANNEL_PIN_2 26
+
+// Telemetría por pulso del generador
+#define PULSE_TELEMETRY_RING_SIZE 256   // Registros en RAM (potencia de 2)
+#define PULSE_TELEMETRY_LATE_US 500     // Error de período a partir del cual un pulso cuenta como tardío
+#define PULSE_TELEMETRY_HIST_BINS 7     // Cubetas del histograma de |error|
+
+// Captura de flancos con timestamp (autotest en lazo cerrado)
+#define LOOPBACK_CAPTURE_PIN 27         // Puentear con SENSOR_PIN para el autotest
+#define PULSE_CAPTURE_RING_SIZE 256     // Timestamps en cola (potencia de 2)
+#define LOOPBACK_MATCH_WINDOW_US 2000   // Latencia máxima para emparejar captura y pulso
+#define LOOPBACK_HIST_BINS 7            // Cubetas del histograma de latencia
+
+// Períodos por pulso en modo READ
+#define READ_CAPTURE_RING_SIZE 256      // Timestamps en cola (potencia de 2)
+#define READ_FRAGMENT_PERCENT 50        // Período menor que este % del anterior = fragmento
+#define READ_BACKEND_DEFAULT 0          // 0 = interrupción GPIO (períodos por pulso), 1 = PCNT (solo cuenta), 2 = captura MCPWM
+#define READ_FLOW_TIMEOUT_MS 4000       // Sin pulsos durante este tiempo = flujo parado (0 Hz)
+#define READ_FLOW_TIMEOUT_MAX_MS 600000  // Tope del comando 'timeout' (en µs tiene que caber en 32 bits)
+#define READ_GATED_ABOVE_HZ 150         // Por encima, cuenta por ventana en lugar de recíproca
+
+// Segmentación de eventos de flujo en modo READ (criterios del gateway)
+#define SEGMENT_TIMEOUT_MS 2000         // Sin pulsos durante este tiempo = fin del flujo
+#define SEGMENT_ABRUPT_PERCENT 30       // Desviación del período estable que abre una TRANSITION
+#define SEGMENT_STABLE_PERCENT 15       // Tolerancia de la racha que declara STABLE
+#define SEGMENT_STABLE_PULSES 8         // Períodos consistentes seguidos para STABLE
+#define SEGMENT_LEAK_MAX_PULSES 3       // Flujos con estos pulsos o menos = fuga
+#define SEGMENT_EVENT_LOG 32            // Eventos guardados para el comando "events"
+
+// Conformidad de la captura con un patrón de referencia en modo READ
+#define CHECK_TOLERANCE_PERCENT 10      // Margen para emparejar un período con el esperado
+#define CHECK_MAX_SPLIT 3               // Trozos de un pulso partido que se intentan sumar
+#define CHECK_MAX_SLIPS 1               // Pulsos perdidos o de más que aún se aceptan
+#define CHECK_MAX_BIAS_PERMILLE 10      // Sesgo medio máximo por fase (1%)
+#define CHECK_MAX_PHASES 16             // Fases con estadística propia
+
+// Cuantiles de período (READ) y presión (PRESSURE) en memoria fija
+#define QUANTILE_SUB_BITS 4             // 16 cubetas por octava: error relativo <= ±3%
+#define QUANTILE_MAX_BITS 27            // Valores hasta 2^27 (134 s en µs, presión de 24 bits)
+#define QUANTILE_WINDOW_SLOTS 8         // Sub-histogramas de la ventana deslizante
+#define QUANTILE_WINDOW_DEFAULT_MS 60000  // Ventana inicial (0 = desde el inicio)
+#define QUANTILE_WINDOW_MAX_MS 3600000  // Más ventana saturaría los contadores de 16 bits
+#define QUANTILE_SUMMARY_INTERVAL_MS 250  // Recalcular P50/P90/P99 para la pantalla
+
+// Contador hardware PCNT (backend de cuenta del modo READ)
+#define PULSE_COUNTER_UNIT 0            // Unidad PCNT (0-7)
+#define PULSE_COUNTER_LIMIT 30000       // Tope del contador de 16 bits: interrupción y vuelta a 0
+#define PULSE_COUNTER_FILTER_NS 10000   // Filtro de glitches (el hardware limita a ~12.8 µs)
+
+// Captura de flancos por hardware (backend MCPWM del modo READ)
+#define EDGE_CAPTURE_UNIT 0             // Unidad MCPWM (0-1), canal de captura 0
+#define EDGE_CAPTURE_RING_SIZE 256      // Períodos y anchos en cola (potencia de 2)
+
+// Totalizador de volumen (persistente en RTC y NVS)
+#define TOTALIZER_K_FACTOR_DEFAULT 450.0f  // Pulsos por litro (caudalímetros tipo YF-S201)
+#define TOTALIZER_MAX_POINTS 8          // Puntos de la tabla de corrección por caudal
+#define TOTALIZER_SLOTS 4               // Claves NVS en rotación para los totales
+#define TOTALIZER_MAX_WRITES_PER_HOUR 6 // Escrituras NVS de totales como mucho (desgaste de flash)
+#define TOTALIZER_NVS_NAMESPACE "totalizer"
+
+// Ficheros de patrón en LittleFS
+#define PATTERN_FILE_DIR "/patterns"
+#define PATTERN_FILE_CHUNK_SIZE 512     // Bytes por bloque de lectura (x2: doble buffer)
+#define PATTERN_FILE_MAX_PHASES 32
+#define PATTERN_FILE_MAX_PULSES 1000000  // Pulsos de un fichero de fases en total (~3 h a 100 Hz)
+
+// Comandos por puerto serie
+#define SERIAL_CMD_MAX_LEN 64
 
 // Períodos en milisegundos - Frecuencias correspondientes
 #define PERIOD_F1  23
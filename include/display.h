@@ -2,6 +2,9 @@
 #define DISPLAY_H
 
 #include "common.h"
+#include "pattern_preview.h"
+#include "quantile_sketch.h"
+#include "pressure_trigger.h"
 
 // Funciones de pantalla comunes
 void mostrarVoltaje();
@@ -13,7 +16,15 @@ void actualizarGrafico(float nueva_frecuencia);
 void actualizarGraficoGenerico(float* data, int* index, float nuevo_valor, 
                                 float min_scale, float max_scale, 
                                 uint16_t color_fill, uint16_t color_line,
-                                bool auto_scale = false);
+                                bool auto_scale = false, const uint16_t* marks = nullptr);
+void marcarGrafico(uint16_t color);
+void dibujarVistaPrevia(const PatternPreview* preview);
+void dibujarCapturaPresion(const PressureCaptureView* view);
+void dibujarLineaInferior(const char* text, uint16_t color);
+void formatearCuantiles(const QuantileSummary* summary, float scale, const char* unit, char* text, int size);
+// Igual, con una conversión monótona por valor (p. ej. calibración de presión)
+void formatearCuantilesConvertidos(const QuantileSummary* summary, float (*convertir)(uint32_t),
+                                   const char* unit, char* text, int size);
 
 // Funciones auxiliares
 void playTone(int frequency, int duration_ms);
@@ -0,0 +1,58 @@
+#ifndef EDGE_CAPTURE_H
+#define EDGE_CAPTURE_H
+
+#include <stdint.h>
+#include "config.h"
+#include "timestamp_ring.h"
+
+// Captura de flancos con la unidad de captura del MCPWM.
+//
+// El hardware congela el contador de captura (reloj APB, 80 MHz: 12.5 ns)
+// en cada flanco de subida y de bajada; la ISR solo recoge el valor, así que
+// la latencia de entrada a la interrupción no afecta a la medida. El
+// contador de 32 bits da la vuelta cada ~53.7 s: la ISR lo extiende a 64
+// bits y usa micros() (grueso, pero sin ambigüedad) para contar las vueltas
+// en huecos más largos.
+//
+// Por cada pulso se publica:
+//   - el instante del flanco de subida en µs, en el anillo de timestamps de
+//     READ (misma base de tiempo que micros(), para el estimador, el
+//     segmentador y la conformidad);
+//   - el período en ticks (subida a subida) y el ancho en ticks (subida a
+//     bajada), en anillos propios.
+//
+// La unidad no tiene filtro de glitches: un rebote se ve como pulso.
+// El acceso al periférico va por una pequeña HAL (edge_capture.cpp): MCPWM
+// en el ESP32 y flancos inyectados en host.
+
+#define EDGE_CAPTURE_TICKS_PER_US 80
+
+typedef TimestampRing<READ_CAPTURE_RING_SIZE> EdgeTimestampRing;
+
+struct EdgeCaptureStats {
+  uint32_t rising;             // Flancos de subida capturados (= pulsos)
+  uint32_t falling;
+  uint32_t wraps;              // Vueltas del contador de captura
+};
+
+extern volatile EdgeCaptureStats edge_capture_stats;
+
+bool edgeCaptureIniciar(uint8_t pin, EdgeTimestampRing* timestamps);
+void edgeCaptureDetener();
+bool edgeCaptureActivo();
+
+// Consumidor (loop): períodos y anchos en ticks; false si no hay más
+bool edgeCaptureLeerPeriodo(uint32_t* ticks);
+bool edgeCaptureLeerAncho(uint32_t* ticks);
+uint32_t edgeCaptureDesbordes();   // Períodos/anchos descartados con el anillo lleno
+
+inline float edgeCaptureTicksAUs(uint32_t ticks) {
+  return (float)ticks / EDGE_CAPTURE_TICKS_PER_US;
+}
+
+#ifndef ARDUINO
+// Sustituto host: flanco capturado con el valor del contador y el micros() de la ISR
+void edgeCaptureHostFlanco(uint32_t ticks, bool rising, uint32_t now_us);
+#endif
+
+#endif
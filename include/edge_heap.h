@@ -0,0 +1,72 @@
+#ifndef EDGE_HEAP_H
+#define EDGE_HEAP_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Min-heap de deadlines de flanco, uno por canal del motor de pulsos.
+//
+// La ISR solo mira la raíz para saber qué canal toca y cuándo re-armar la
+// alarma: el coste por flanco es O(log N) en lugar de recorrer todos los
+// canales. Las funciones son inline para que la ISR no salte a flash.
+
+struct EdgeHeapEntry {
+  uint64_t deadline_us;
+  uint8_t channel;
+};
+
+struct EdgeHeap {
+  EdgeHeapEntry entries[PULSE_OUTPUT_MAX_CHANNELS];
+  int size;
+};
+
+inline void edgeHeapVaciar(EdgeHeap* heap) {
+  heap->size = 0;
+}
+
+inline bool edgeHeapVacio(const EdgeHeap* heap) {
+  return heap->size == 0;
+}
+
+// Raíz: el flanco más próximo (el heap no debe estar vacío)
+inline const EdgeHeapEntry& edgeHeapMinimo(const EdgeHeap* heap) {
+  return heap->entries[0];
+}
+
+inline bool edgeHeapInsertar(EdgeHeap* heap, uint64_t deadline_us, uint8_t channel) {
+  if (heap->size >= PULSE_OUTPUT_MAX_CHANNELS) return false;
+
+  // Subir el hueco hasta su sitio
+  int i = heap->size++;
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (heap->entries[parent].deadline_us <= deadline_us) break;
+    heap->entries[i] = heap->entries[parent];
+    i = parent;
+  }
+  heap->entries[i].deadline_us = deadline_us;
+  heap->entries[i].channel = channel;
+  return true;
+}
+
+inline EdgeHeapEntry edgeHeapExtraer(EdgeHeap* heap) {
+  EdgeHeapEntry top = heap->entries[0];
+  EdgeHeapEntry last = heap->entries[--heap->size];
+
+  // Bajar el último elemento desde la raíz
+  int i = 0;
+  while (true) {
+    int child = 2 * i + 1;
+    if (child >= heap->size) break;
+    if (child + 1 < heap->size && heap->entries[child + 1].deadline_us < heap->entries[child].deadline_us) {
+      child++;
+    }
+    if (last.deadline_us <= heap->entries[child].deadline_us) break;
+    heap->entries[i] = heap->entries[child];
+    i = child;
+  }
+  if (heap->size > 0) heap->entries[i] = last;
+  return top;
+}
+
+#endif
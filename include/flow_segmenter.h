@@ -0,0 +1,89 @@
+#ifndef FLOW_SEGMENTER_H
+#define FLOW_SEGMENTER_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Segmentación en línea del flujo de pulsos en eventos, con los criterios
+// del gateway (ANALISIS_TC_1_2_3.md, docs/test_cases_sequences.md):
+//
+//   STARTUP     primeros pulsos de un flujo, hasta que se estabiliza
+//   STABLE      SEGMENT_STABLE_PULSES períodos seguidos dentro de
+//               ±SEGMENT_STABLE_PERCENT de su media
+//   TRANSITION  un período se aleja más de SEGMENT_ABRUPT_PERCENT del período
+//               estable (cambio abrupto)
+//   STOP        último evento del flujo, más lento que el STABLE más largo del
+//               flujo (o transición que se frena, si no hubo STABLE):
+//               parada gradual antes del timeout. Un STARTUP que nunca se
+//               estabiliza y se frena al final (TC1) se parte por su
+//               período más rápido: STARTUP hasta ahí y STOP el resto
+//   LEAK        flujo completo de SEGMENT_LEAK_MAX_PULSES pulsos o menos
+//
+// El flujo termina tras SEGMENT_TIMEOUT_MS sin pulsos. O(1) por pulso: la
+// frontera STARTUP/TRANSITION -> STABLE se coloca al inicio de la racha
+// estable moviendo contadores, sin guardar los períodos.
+//
+// Los pulsos de un flujo se reparten entre sus eventos sin solaparse: cada
+// pulso pertenece al evento de su período (el primero del flujo, al primer
+// evento). Un evento empieza en el último flanco del anterior, así que las
+// duraciones también suman la del flujo.
+
+enum FlowEventType {
+  FLOW_EVENT_STARTUP,
+  FLOW_EVENT_STABLE,
+  FLOW_EVENT_TRANSITION,
+  FLOW_EVENT_STOP,
+  FLOW_EVENT_LEAK
+};
+
+struct FlowEvent {
+  FlowEventType type;
+  uint32_t flow;           // Número de flujo (IDLE -> ... -> timeout)
+  uint32_t pulses;
+  uint32_t periods;        // Períodos medidos dentro del evento
+  uint64_t period_sum_us;
+  uint32_t start_us;
+  uint32_t end_us;         // Último flanco del evento
+  bool timeout;            // Cerrado por fin de flujo
+};
+
+struct FlowSegmenter {
+  uint32_t timeout_us;
+  bool in_flow;
+  bool skip_period;        // Flancos perdidos: el próximo período no es real
+  uint32_t flow_count;
+  uint32_t flow_pulses;
+  uint32_t last_edge_us;
+  uint32_t first_period_us;  // Del evento en curso (para reconocer STOP)
+  uint32_t last_period_us;
+  FlowEvent current;
+  // Racha de períodos consistentes (STARTUP / TRANSITION)
+  uint32_t run_periods;
+  uint64_t run_sum_us;
+  uint32_t run_start_us;
+  uint32_t run_first_period_us;
+  // Período de referencia del evento STABLE
+  uint32_t stable_ref_us;
+  // STABLE más largo ya cerrado del flujo (referencia para STOP)
+  uint32_t flow_ref_us;
+  uint32_t flow_ref_pulses;
+  // STARTUP hasta su período más rápido (punto de corte si acaba frenando)
+  uint32_t fastest_period_us;
+  FlowEvent fastest;
+  bool stop_pending;       // Timeout ya tratado: queda por cerrar el STOP
+};
+
+void segmentadorIniciar(FlowSegmenter* seg, uint32_t timeout_ms);
+void segmentadorDiscontinuidad(FlowSegmenter* seg);
+
+// Devuelven true si se ha cerrado un evento (copiado en closed). Un timeout
+// puede cerrar dos (STARTUP y STOP): llamar a segmentadorTick hasta que
+// devuelva false.
+bool segmentadorPulso(FlowSegmenter* seg, uint32_t t_us, FlowEvent* closed);
+bool segmentadorTick(FlowSegmenter* seg, uint32_t now_us, FlowEvent* closed);
+
+const char* segmentadorNombreTipo(FlowEventType type);
+uint32_t segmentadorDuracionMs(const FlowEvent* event);
+float segmentadorPeriodoMedioMs(const FlowEvent* event);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef FLOW_TOTALIZER_H
+#define FLOW_TOTALIZER_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Totalizador de volumen que sobrevive a cambios de modo, sleep y reinicios.
+//
+// Los pulsos se convierten a volumen con el factor K (pulsos por litro) y
+// una tabla de corrección por frecuencia (interpolación lineal entre puntos;
+// fuera de la tabla, el punto más cercano). El volumen se acumula en µL
+// enteros: sin deriva de float en pruebas largas.
+//
+// Persistencia en dos niveles, ninguno en el camino de los pulsos:
+//   - RTC (RTC_NOINIT): copia con CRC actualizada en cada suma. Sobrevive al
+//     deep sleep y a los reinicios por software/pánico/watchdog.
+//   - NVS: registros con CRC rotando entre TOTALIZER_SLOTS claves, como
+//     mucho TOTALIZER_MAX_WRITES_PER_HOUR escrituras por hora y solo si hay
+//     cambios. Cada escritura va a la clave siguiente, así que un corte a
+//     mitad deja intacto el registro anterior.
+// Al arrancar se usa la copia RTC si es válida y no es más antigua que el
+// último registro NVS válido; si no, el registro NVS de mayor secuencia.
+// Tras un corte de alimentación se pierde como mucho lo contado desde la
+// última escritura.
+//
+// El acceso a RTC/NVS va por una pequeña HAL (flow_totalizer.cpp):
+// Preferences en el ESP32 y memoria simulada en host.
+
+enum TotalizerSource {
+  TOTALIZER_FROM_NONE,   // Sin datos guardados: totales a cero
+  TOTALIZER_FROM_RTC,
+  TOTALIZER_FROM_NVS
+};
+
+struct TotalizerTotals {
+  uint64_t pulses;
+  uint64_t volume_ul;
+  uint32_t seq;          // Secuencia del último registro escrito en NVS
+};
+
+struct TotalizerConfig {
+  float k_factor;        // Pulsos por litro
+  int point_count;
+  float point_hz[TOTALIZER_MAX_POINTS];      // Ordenados de menor a mayor
+  float point_factor[TOTALIZER_MAX_POINTS];  // Multiplicador del volumen a esa frecuencia
+};
+
+struct TotalizerStats {
+  TotalizerSource source;
+  uint32_t writes;           // Escrituras NVS desde el arranque
+  uint32_t write_errors;
+  uint32_t last_write_ms;
+  bool dirty;                // Cambios pendientes de escribir en NVS
+};
+
+extern TotalizerTotals totalizer_totals;
+extern TotalizerConfig totalizer_config;
+extern TotalizerStats totalizer_stats;
+
+// Recupera configuración y totales (llamar una vez al arrancar)
+TotalizerSource totalizadorIniciar(uint32_t now_ms);
+
+// Camino caliente: solo RAM y RTC
+void totalizadorSumar(uint32_t pulses, float freq_hz);
+
+// Escribe en NVS si hay cambios y lo permite el límite por hora
+void totalizadorServicio(uint32_t now_ms);
+uint32_t totalizadorEsperaEscrituraMs(uint32_t now_ms);  // 0 = se puede escribir ya
+
+void totalizadorPuestaACero();
+float totalizadorLitros();
+float totalizadorFactorCorreccion(float freq_hz);
+
+// Configuración (se guarda en NVS al cambiarla, fuera del límite de totales)
+bool totalizadorConfigurarK(float k_factor);
+bool totalizadorPuntoCorreccion(float freq_hz, float factor);
+void totalizadorBorrarCorreccion();
+
+const char* totalizadorNombreOrigen(TotalizerSource source);
+
+#ifndef ARDUINO
+// Sustituto host: reinicio (con o sin pérdida de la RAM RTC) y cortes a mitad de escritura
+void totalizadorHostReinicio(bool power_loss);
+void totalizadorHostCorromperSlot(int slot);
+#endif
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef FREQUENCY_ESTIMATOR_H
+#define FREQUENCY_ESTIMATOR_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Estimador de frecuencia del modo READ, de 0.3 a cientos de Hz.
+//
+// - Recíproco (tasas bajas): pulsos / tiempo entre el primer y el último
+//   flanco, tomando como primero el último flanco de la ventana anterior.
+//   Un solo pulso por ventana ya da la frecuencia exacta.
+// - Por ventana (tasas altas o sin timestamps): pulsos contados / duración
+//   de la ventana. Con cientos de pulsos por ventana la resolución ya es
+//   buena y no depende de que el anillo de timestamps no se desborde.
+// - Entre pulsos el valor se mantiene mientras no pase un período; después
+//   cae como 1 / (tiempo desde el último flanco), sin saltos a 0. Sin pulsos
+//   durante timeout, el flujo se da por parado (0 Hz).
+//
+// No depende de Arduino: los tiempos llegan en µs desde el llamador.
+
+enum FrequencyMethod {
+  FREQ_METHOD_STOPPED,
+  FREQ_METHOD_RECIPROCAL,
+  FREQ_METHOD_GATED
+};
+
+struct FrequencyEstimator {
+  bool timestamps;            // Llegan flancos con timestamp (backend ISR)
+  bool have_reference;
+  uint32_t reference_us;      // Último flanco ya usado
+  uint32_t last_edge_us;
+  uint32_t edges;             // Flancos posteriores a reference_us
+  uint32_t timeout_us;
+  FrequencyMethod method;
+  float frequency_hz;
+};
+
+void frecuenciaIniciar(FrequencyEstimator* est, bool timestamps, uint32_t timeout_ms);
+void frecuenciaTimeout(FrequencyEstimator* est, uint32_t timeout_ms);
+void frecuenciaFlanco(FrequencyEstimator* est, uint32_t t_us);
+void frecuenciaDiscontinuidad(FrequencyEstimator* est);  // Flancos perdidos
+
+// Cierra una ventana: gate_pulses contados en gate_us (cuenta de pulse_count)
+float frecuenciaActualizar(FrequencyEstimator* est, uint32_t now_us, uint32_t gate_pulses, uint32_t gate_us);
+
+const char* frecuenciaNombreMetodo(FrequencyMethod method);
+
+#endif
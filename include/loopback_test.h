@@ -0,0 +1,48 @@
+#ifndef LOOPBACK_TEST_H
+#define LOOPBACK_TEST_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Autotest en lazo cerrado: el generador (canal 0, SENSOR_PIN) emite y
+// LOOPBACK_CAPTURE_PIN, puenteado con él, captura los flancos a la vez.
+//
+// Los flancos generados salen de la telemetría del motor (seq + timestamp)
+// y los capturados del anillo de pulse_capture; se emparejan en streaming
+// por orden de tiempo dentro de LOOPBACK_MATCH_WINDOW_US:
+//   - captura sin pulso generado previo -> pulso extra (glitch, rebote...)
+//   - pulso generado sin captura a tiempo -> pulso perdido
+// De cada pareja se acumulan la latencia generado->capturado y el error del
+// período capturado frente al planificado (precisión extremo a extremo).
+
+struct LoopbackSummary {
+  uint32_t generated;
+  uint32_t captured;
+  uint32_t matched;
+  uint32_t missed;
+  uint32_t extra;
+  uint32_t lost_records;      // Registros de telemetría sobrescritos antes de leerlos
+  uint32_t min_latency_us;
+  uint32_t max_latency_us;
+  uint64_t sum_latency_us;
+  uint64_t sum_sq_latency_us;
+  uint32_t histogram[LOOPBACK_HIST_BINS];  // Latencia
+  uint32_t period_count;      // Períodos capturados entre pulsos consecutivos emparejados
+  int64_t sum_period_error_us;
+  uint32_t max_abs_period_error_us;
+};
+
+extern const uint32_t LOOPBACK_HIST_LIMITS_US[LOOPBACK_HIST_BINS - 1];
+
+void loopbackReset();
+void loopbackProcesar(uint32_t now_us);   // Empareja lo disponible hasta now_us
+void loopbackFinalizar(uint32_t now_us);  // Resuelve lo pendiente al acabar el patrón
+void loopbackObtenerResumen(LoopbackSummary* out);
+
+#ifdef ARDUINO
+void loopbackActivar(bool active);
+bool loopbackActivo();
+void loopbackImprimirInforme();
+#endif
+
+#endif
@@ -2,25 +2,55 @@
 #define MODE_PRESSURE_H
 
 #include "common.h"
-#include <Wire.h>
+#include "quantile_sketch.h"
+#include "pressure_trigger.h"
 
 // Variables específicas del modo PRESSURE
 extern float pressure_graph_data[GRAPH_WIDTH];
 extern int pressure_graph_index;
 extern float pressure_min_scale;
 extern float pressure_max_scale;
-extern float pressure_historical_min;
-extern float pressure_historical_max;
-extern bool pressure_history_initialized;
+extern bool pressure_scale_valid;
+extern uint32_t pressure_scale_window_ms;   // Ventana de la autoescala (0 = lo visible)
+extern uint32_t pressure_scale_changes;     // Cambios de escala desde que se reinició
 extern unsigned long last_pressure_read;
 extern bool pressure_auto_scale;
+extern QuantileSketch pressure_sketch;   // Lecturas crudas en la ventana de cuantiles
+extern QuantileSummary pressure_summary;
+
+// Adquisición: normal (PRESSURE_READ_INTERVAL_MS a 100 kHz) o ráfaga
+// (I2C a 400 kHz, conversión continua y decimador CIC hacia la pantalla)
+struct PressureAcquisitionReport {
+  float rate_hz;               // Muestras a tasa completa por segundo
+  float output_hz;             // Salidas del decimador por segundo
+  float noise_raw;             // Desviación típica a tasa completa (cuentas)
+  float noise_output;          // Desviación típica tras el decimador (cuentas)
+  float cpu_percent;           // Carga de la tarea de muestreo en su núcleo
+};
+
+extern bool pressure_burst;
+extern uint32_t pressure_burst_period_us;
+extern int pressure_burst_decimation;
+extern int pressure_burst_cic_order;
+extern PressureAcquisitionReport pressure_report;
+extern uint32_t pressure_last_raw;       // Última salida a tasa de pantalla (cuentas)
+extern int pressure_capture_view;        // Captura en pantalla (0 = la última, -1 = gráfico en curso)
+extern int pressure_capture_zoom;
 
 // Funciones del modo PRESSURE
-WNK1MA_Reading readWNK1MA();
 void inicializarModoPressure();
+void finalizarModoPressure();
 void manejarModoPressure();
-void actualizarHistoricoPresion(float nuevo_valor);
-void actualizarGraficoPresion(float nuevo_valor);
+void actualizarEscalaPresion(float nuevo_valor, uint32_t now_ms);
+void actualizarGraficoPresion(float nuevo_valor, uint32_t now_ms);
 void mostrarInfoSensorPressure();
+bool configurarRafagaPresion(bool burst, uint32_t period_us, int decimation, int cic_order);
+void mostrarAdquisicionPresion();
+void exportarPresion(int count);         // Vuelca por serie las próximas count muestras a tasa completa
+void reiniciarEscalaPresion();           // Tras cambiar la calibración o la unidad
+bool configurarVentanaEscalaPresion(uint32_t window_ms);  // 0 = lo visible
+const char* nombreDisparoPresion(PressureTriggerMode mode);
+bool volcarCapturaPresion(int age);      // CSV de la captura (0 = la última)
+bool verCapturaPresion(int age, int zoom);  // age -1 vuelve al gráfico en curso
 
 #endif
@@ -2,16 +2,60 @@
 #define MODE_READ_H
 
 #include "common.h"
+#include "frequency_estimator.h"
+#include "flow_segmenter.h"
+#include "quantile_sketch.h"
+
+// Períodos medidos flanco a flanco (timestamps de la ISR)
+struct ReadPeriodStats {
+  unsigned long count;       // Períodos medidos
+  uint32_t last_us;
+  uint32_t window_min_us;    // Mín/máx desde el último informe por serie
+  uint32_t window_max_us;
+  unsigned long fragments;   // Períodos < READ_FRAGMENT_PERCENT del anterior
+  uint32_t overflows;        // Timestamps perdidos con el anillo lleno
+  // Backend MCPWM: período y ancho del pulso en ticks de captura (12.5 ns)
+  uint32_t last_period_ticks;
+  uint32_t last_width_ticks;
+  uint32_t window_width_min_ticks;
+  uint32_t window_width_max_ticks;
+};
+
+// Origen de la cuenta de pulsos
+enum ReadBackend {
+  READ_BACKEND_ISR,   // attachInterrupt por flanco: cuenta y períodos por pulso
+  READ_BACKEND_PCNT,  // Contador hardware con filtro de glitches: solo cuenta
+  READ_BACKEND_MCPWM  // Captura hardware de ambos flancos: períodos y anchos sin jitter de ISR
+};
 
 // Variables específicas del modo READ
 extern volatile unsigned long pulse_count;
 extern unsigned long last_pulse_count;
 extern unsigned long last_pulse_time;
 extern float pulse_frequency;
+extern ReadPeriodStats read_period_stats;
+extern bool read_period_log;  // Volcar cada período por serie ("periods on")
+extern ReadBackend read_backend;
+extern FrequencyEstimator read_estimator;
+extern uint32_t read_flow_timeout_ms;
+extern FlowSegmenter read_segmenter;
+extern QuantileSketch read_period_sketch;  // Períodos (µs) en la ventana de cuantiles
+extern QuantileSummary read_period_summary;
+extern bool read_check_active;  // Comparando la captura con un test case
+extern TestCase read_check_tc;
 
 // Funciones del modo READ
 void IRAM_ATTR pulseInterrupt();
 void inicializarModoRead();
+void finalizarModoRead();
+void seleccionarBackendRead(ReadBackend backend);
+void configurarTimeoutFlujoRead(uint32_t timeout_ms);
+void mostrarEventosRead();
+void seleccionarReferenciaRead(bool enabled, TestCase tc);
+void manejarBotonIzquierdoRead();
+void mostrarVerificacionRead();
+void mostrarTotalesTestCases();
+const char* nombreBackendRead(ReadBackend backend);
 void manejarModoRead();
 void mostrarInfoSensorRead();
 
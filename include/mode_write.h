@@ -2,6 +2,15 @@
 #define MODE_WRITE_H
 
 #include "common.h"
+#include "pattern_preview.h"
+
+// Canal del generador: patrón propio sobre su GPIO
+struct WriteChannel {
+  bool enabled;
+  TestCase test;
+  PatternStream stream;
+  bool stream_done;
+};
 
 // Variables específicas del modo WRITE
 extern bool generating_pulse;
@@ -13,26 +22,31 @@ extern bool pulse_state;
 extern unsigned long pulse_count_generated;
 extern TestCase current_test;
 extern unsigned long test_start_time;
-extern PulsePattern pulse_pattern;
+extern PatternTable pulse_pattern;
+extern PatternPreview write_preview;
+extern WriteChannel write_channels[WRITE_CHANNEL_COUNT];
+extern const uint8_t WRITE_CHANNEL_PINS[WRITE_CHANNEL_COUNT];
 extern int current_pulse_index;
 extern bool pattern_ready;
-
-// Arrays de fases para cada test case
-extern PulsePhase test1_phases[];
-extern PulsePhase test2_phases[];
-extern PulsePhase test3_phases[];
-extern PulsePhase test4_phases[];
-extern PulsePhase test5_phases[];
+extern bool pattern_from_file;
+extern char pattern_file_name[32];
 
 // Funciones del modo WRITE
 void inicializarGenerador();
-void preGenerarPatron(TestCase tc);
+void cargarPatron(TestCase tc);
+bool cargarPatronArchivo(const char* name);
 void generarPulsos();
 void manejarModoWrite();
 void manejarBotonIzquierdoWrite();
+void reiniciarReproduccionWrite();
+bool configurarCanalWrite(int ch, bool enabled, TestCase tc);
+void mostrarCanalesWrite();
+void redibujarPantallaWrite(const char* title);
 
 // Funciones auxiliares
-float aplicarJitter(float tempo, float jitter_percent, unsigned long pulse_number);
-PulsePhase* getTestPhases(TestCase tc, int* phase_count);
+void preGenerarPatron(TestCase tc, PulsePattern* out);
+bool verificarTablasPatron();
+void benchmarkCodecPatrones();
+void benchmarkSintetizador();
 
 #endif
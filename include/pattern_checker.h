@@ -0,0 +1,90 @@
+#ifndef PATTERN_CHECKER_H
+#define PATTERN_CHECKER_H
+
+#include <stdint.h>
+#include "config.h"
+#include "pulse_pattern.h"
+
+// Conformidad en línea de los períodos capturados con un patrón de
+// referencia (test case o fichero), sin guardar la captura.
+//
+// El pulso i del generador va seguido del período i, así que entre el primer
+// y el último flanco de un patrón de N pulsos se miden N-1 períodos. Cada
+// período capturado se alinea con el siguiente esperado usando una ventana
+// de dos períodos del stream de referencia:
+//
+//   captura ~ e[k]              coincide
+//   captura ~ e[k] + e[k+1]     falta el pulso k+1 (se salta e[k+1])
+//   captura < e[k]              posible pulso de más: se acumula con los
+//                               siguientes (hasta CHECK_MAX_SPLIT trozos)
+//                               y coincide si la suma ~ e[k]
+//   resto                       período erróneo, se avanza uno
+//
+// "~" es dentro de ±CHECK_TOLERANCE_PERCENT. Como la referencia lleva el
+// mismo jitter determinista que el generador, el error de un período que
+// coincide es solo el de temporización (µs), y cada fase acumula el sesgo
+// medio y el error máximo.
+
+enum CheckVerdict {
+  CHECK_WAITING,   // Sin períodos todavía
+  CHECK_RUNNING,   // En curso y conforme hasta ahora
+  CHECK_FAILING,   // En curso y ya no conforme
+  CHECK_PASS,
+  CHECK_FAIL
+};
+
+struct CheckPhaseStats {
+  uint32_t expected;       // Períodos medibles de la fase
+  uint32_t matched;        // Esperados ya cubiertos (coincidencias y fallos de pulso)
+  uint32_t missed;
+  uint32_t extra;
+  uint32_t mismatched;
+  int64_t error_sum_us;    // Capturado - esperado
+  uint64_t expected_sum_us;
+  uint32_t max_error_permille;
+};
+
+struct PatternChecker {
+  PatternStream stream;
+  const PulsePhase* phases;    // nullptr: una sola fase (fichero de períodos)
+  int phase_count;
+  CheckPhaseStats stats[CHECK_MAX_PHASES];
+  int stats_count;             // Fases de más se acumulan en la última
+  uint32_t expected_periods;
+  uint64_t expected_us;
+  // Ventana de referencia: e[k] y e[k+1] con su fase
+  uint32_t window_us[2];
+  uint8_t window_phase[2];
+  int window_count;
+  uint32_t pulled;             // Períodos leídos del stream
+  int stream_phase;            // Fase del próximo período del stream
+  uint32_t stream_phase_end;
+  // Pulso partido pendiente de completar
+  uint32_t pending_us;
+  int pending_pieces;
+  // Totales
+  uint32_t consumed;           // Esperados ya cubiertos
+  uint32_t captured;
+  uint32_t missed;
+  uint32_t extra;
+  uint32_t mismatched;
+  uint32_t trailing;           // Períodos después del final del patrón
+  bool lost_sync;              // Timestamps perdidos: la alineación no es fiable
+};
+
+// La referencia se recorre sobre una copia reiniciada del stream. phases
+// (opcional) reparte la estadística por fases; debe describir el mismo patrón.
+void verificadorIniciar(PatternChecker* checker, const PatternStream* stream,
+                        const PulsePhase* phases, int phase_count);
+void verificadorPeriodo(PatternChecker* checker, uint32_t period_us);
+void verificadorDiscontinuidad(PatternChecker* checker);
+
+CheckVerdict verificadorVeredicto(const PatternChecker* checker);
+const char* verificadorNombreVeredicto(CheckVerdict verdict);
+bool verificadorFaseConforme(const CheckPhaseStats* stats);
+float verificadorSesgoPorciento(const CheckPhaseStats* stats);
+
+// Totales esperados de un patrón: pulsos, períodos medibles y duración
+void verificadorTotales(const PatternStream* stream, uint32_t* pulses, uint32_t* periods, uint64_t* duration_us);
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef PATTERN_CODEC_H
+#define PATTERN_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Codificación compacta de períodos (µs).
+//
+// Cada período se guarda como delta respecto al anterior (el primero respecto
+// a 0), en zig-zag para que las deltas negativas pequeñas también ocupen poco,
+// y en varint LEB128 (7 bits por byte, bit alto = continúa). Un patrón estable
+// con jitter ocupa 1-2 bytes por pulso en lugar de los 4 de un float.
+//
+// Las funciones son constexpr para poder codificar las tablas en compilación.
+
+constexpr uint32_t zigzagCodificar(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+constexpr int32_t zigzagDecodificar(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+constexpr int varintLongitud(uint32_t value) {
+  int length = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    length++;
+  }
+  return length;
+}
+
+constexpr int varintEscribir(uint8_t* out, uint32_t value) {
+  int length = 0;
+  while (value >= 0x80) {
+    out[length++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[length++] = (uint8_t)value;
+  return length;
+}
+
+// Bytes necesarios para codificar un período tras el anterior
+constexpr int periodoLongitudCodificada(uint32_t previous_us, uint32_t period_us) {
+  return varintLongitud(zigzagCodificar((int32_t)(period_us - previous_us)));
+}
+
+// Decodificador incremental (lo usa el generador: O(1) por período)
+struct PeriodDecoder {
+  const uint8_t* data;
+  uint32_t size;
+  uint32_t pos;
+  uint32_t previous_us;
+};
+
+inline void periodDecoderIniciar(PeriodDecoder* decoder, const uint8_t* data, uint32_t size) {
+  decoder->data = data;
+  decoder->size = size;
+  decoder->pos = 0;
+  decoder->previous_us = 0;
+}
+
+inline bool periodDecoderSiguiente(PeriodDecoder* decoder, uint32_t* period_us) {
+  uint32_t value = 0;
+  int shift = 0;
+  while (decoder->pos < decoder->size) {
+    uint8_t byte = decoder->data[decoder->pos++];
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      decoder->previous_us += (uint32_t)zigzagDecodificar(value);
+      *period_us = decoder->previous_us;
+      return true;
+    }
+    shift += 7;
+    if (shift > 28) return false;  // Varint corrupto
+  }
+  return false;
+}
+
+// Codifica count períodos en out; devuelve bytes escritos o 0 si no caben
+uint32_t codificarPeriodos(const uint32_t* periods_us, int count, uint8_t* out, uint32_t capacity);
+
+#endif
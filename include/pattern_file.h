@@ -0,0 +1,113 @@
+#ifndef PATTERN_FILE_H
+#define PATTERN_FILE_H
+
+#include <stdint.h>
+#include "config.h"
+#include "pulse_pattern.h"
+
+// Ficheros de patrón (.pat) para cargar escenarios sin recompilar.
+//
+// Formato (little-endian):
+//   Cabecera (20 bytes)
+//     0  "PPAT"
+//     4  u8  versión (PATTERN_FILE_VERSION)
+//     5  u8  tipo: 0 = períodos, 1 = fases
+//     6  u16 reservado (0)
+//     8  u32 count: pulsos (períodos) o número de fases (fases)
+//    12  u32 tamaño del payload en bytes
+//    16  u32 CRC-32 (IEEE, el de zlib) del payload
+//   Payload
+//     períodos: deltas zig-zag varint en µs (pattern_codec.h), como las tablas de flash
+//     fases: count registros de 17 bytes
+//       u8 tipo (PhaseType; bit 7 = jitter gaussiano), f32 tempo inicial ms,
+//       f32 tempo final ms, u32 pulsos, f32 jitter %
+//
+// El lector no depende de Arduino: el acceso al fichero va por PatternFileIo
+// (LittleFS en el ESP32, stdio en host) y el mismo código valida en ambos.
+// Los períodos se leen por bloques con doble buffer: mientras se decodifica
+// un bloque el otro ya está cargado, y la recarga se hace con
+// patternFileRellenar() fuera del camino que alimenta al motor.
+
+#define PATTERN_FILE_MAGIC "PPAT"
+#define PATTERN_FILE_VERSION 1
+#define PATTERN_FILE_HEADER_SIZE 20
+#define PATTERN_FILE_PHASE_SIZE 17
+#define PATTERN_FILE_PHASE_GAUSSIAN 0x80
+
+enum PatternFileKind {
+  PATTERN_FILE_PERIODS = 0,
+  PATTERN_FILE_PHASES = 1
+};
+
+enum PatternFileError {
+  PATTERN_FILE_OK,
+  PATTERN_FILE_ERR_READ,      // Fichero truncado o error de E/S
+  PATTERN_FILE_ERR_MAGIC,
+  PATTERN_FILE_ERR_VERSION,
+  PATTERN_FILE_ERR_KIND,
+  PATTERN_FILE_ERR_SIZE,      // count/payload incoherentes, demasiadas fases o pulsos
+  PATTERN_FILE_ERR_CRC,
+  PATTERN_FILE_ERR_DATA       // Varint corrupto, período nulo, fase inválida...
+};
+
+struct PatternFileHeader {
+  uint8_t version;
+  uint8_t kind;
+  uint32_t count;
+  uint32_t payload_size;
+  uint32_t crc32;
+};
+
+// Acceso al fichero: leer devuelve los bytes leídos; rebobinar se posiciona en offset
+struct PatternFileIo {
+  int (*leer)(void* ctx, uint8_t* buffer, int length);
+  bool (*rebobinar)(void* ctx, uint32_t offset);
+  void* ctx;
+};
+
+struct PatternFileReader {
+  PatternFileIo io;
+  PatternFileHeader header;
+  PatternFileError error;
+  // Períodos: doble buffer del payload
+  uint8_t buffers[2][PATTERN_FILE_CHUNK_SIZE];
+  int buffer_length[2];
+  bool buffer_loaded[2];
+  int active;
+  int pos;
+  uint32_t payload_loaded;   // Bytes del payload ya leídos del fichero
+  uint32_t crc32;            // CRC acumulado de lo leído
+  uint32_t decoded;          // Períodos decodificados
+  uint32_t previous_us;
+  uint32_t stalls;           // Bloques que hubo que leer al vuelo (sin precarga)
+  // Fases: se cargan enteras al abrir
+  PulsePhase phases[PATTERN_FILE_MAX_PHASES];
+};
+
+struct PatternFileInfo {
+  uint8_t kind;
+  int pulse_count;
+  uint32_t total_ms;
+  uint32_t payload_size;
+};
+
+uint32_t patternFileCrc32(uint32_t crc, const uint8_t* data, uint32_t length);
+const char* patternFileNombreError(PatternFileError error);
+
+// Lee y comprueba la cabecera; en ficheros de fases carga también las fases
+PatternFileError patternFileAbrir(PatternFileReader* reader, const PatternFileIo& io);
+
+// Recorre el fichero completo y comprueba CRC y contenido. Deja el lector
+// abierto: el stream creado después con patternStreamDesdeArchivo empieza
+// desde el principio.
+PatternFileError patternFileValidar(PatternFileReader* reader, const PatternFileIo& io, PatternFileInfo* info);
+
+// Stream de reproducción sobre un lector abierto (fases: PATTERN_SOURCE_PHASES)
+void patternStreamDesdeArchivo(PatternStream* stream, PatternFileReader* reader);
+
+// Períodos del payload (lo usa patternStreamSiguiente)
+bool patternFileReiniciar(PatternFileReader* reader);
+bool patternFileSiguientePeriodo(PatternFileReader* reader, uint32_t* period_us);
+void patternFileRellenar(PatternFileReader* reader);
+
+#endif
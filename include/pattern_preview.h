@@ -0,0 +1,37 @@
+#ifndef PATTERN_PREVIEW_H
+#define PATTERN_PREVIEW_H
+
+#include <stdint.h>
+#include "config.h"
+#include "pulse_pattern.h"
+
+// Vista previa de patrones de cualquier longitud.
+//
+// El eje de tiempo se ajusta a la duración del patrón (column_us por
+// columna) y cada columna guarda la envolvente min/max de la frecuencia de
+// todos los pulsos que la tocan: ráfagas y pausas más cortas que una
+// columna siguen viéndose.
+//
+// Una pasada por el stream guarda el instante de fin de cada pulso (suma
+// prefija de los períodos) y cada columna localiza su primer y último pulso
+// con búsqueda binaria. Si el patrón no cabe en PATTERN_PREVIEW_MAX_PULSES
+// (o no hay memoria) se reparte en una segunda pasada pulso a pulso: mismo
+// resultado, sin memoria extra.
+
+struct PatternPreview {
+  float freq_min[GRAPH_WIDTH];   // Hz por columna
+  float freq_max[GRAPH_WIDTH];
+  int width;                     // Columnas con patrón (<= GRAPH_WIDTH)
+  uint32_t column_us;            // Tiempo que cubre cada columna
+  int pulse_count;
+  uint32_t total_ms;
+};
+
+// No consume el stream: recorre copias reiniciadas. Con PATTERN_SOURCE_FILE
+// el lector es compartido y hay que reiniciar el stream después.
+void patternPreviewConstruir(const PatternStream* stream, PatternPreview* preview);
+
+// Construcción sobre la suma prefija ya calculada (end_us[i] = fin del pulso i)
+void patternPreviewDesdePrefijos(const uint32_t* end_us, int count, PatternPreview* preview);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef PATTERN_STORAGE_H
+#define PATTERN_STORAGE_H
+
+#include "common.h"
+#include "pattern_file.h"
+
+// Ficheros de patrón en LittleFS (PATTERN_FILE_DIR).
+// El fichero abierto se mantiene abierto mientras se reproduce: el lector
+// lo lee por bloques desde el loop.
+
+bool inicializarAlmacenPatrones();
+void listarPatronesArchivo();
+
+// Abre "<nombre>" o "<nombre>.pat" de PATTERN_FILE_DIR y lo valida.
+// Devuelve PATTERN_FILE_OK con reader listo para patternStreamDesdeArchivo.
+PatternFileError abrirPatronArchivo(const char* name, PatternFileReader* reader, PatternFileInfo* info);
+void cerrarPatronArchivo();
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef PATTERN_SYNTH_H
+#define PATTERN_SYNTH_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Sintetizador de períodos en punto fijo para la generación en runtime.
+// Se incluye desde pulse_pattern.h (necesita PulsePhase y exp2Constexpr).
+//
+// Sustituye, en los patrones que se calculan bajo demanda (TC9, ficheros de
+// fases), la aritmética float/double del generador constexpr:
+//   - easing 1 - 2^(-10p) desde una LUT en flash con interpolación lineal
+//     (progreso en Q24, easing en Q16)
+//   - jitter con splitmix64 indexado por número de pulso (sin estado,
+//     reproducible) en lugar del LCG con módulo y división float
+//   - jitter uniforme (±jitter_percent) o gaussiano (σ = jitter_percent / 2,
+//     suma de 4 uniformes, acotado a ±1.73 * jitter_percent)
+// Solo enteros en el camino por pulso: mismo resultado en ESP32 y en host.
+//
+// Las tablas de TC1-TC5 siguen generándose con calcularPeriodoUs: deben
+// coincidir bit a bit con el generador runtime de referencia (verify).
+
+#define EASING_LUT_BITS 10
+#define EASING_LUT_SIZE ((1 << EASING_LUT_BITS) + 1)
+#define PATTERN_SYNTH_SEED 0x5EED5EEDUL
+
+// easing(i / 1024) en Q16 redondeado (65536 no aparece: f(1 - ε) < 1)
+struct EasingLut {
+  uint16_t values[EASING_LUT_SIZE];
+};
+
+constexpr EasingLut generarLutEasing() {
+  EasingLut lut{};
+  for (int i = 0; i < EASING_LUT_SIZE; i++) {
+    double value = 1.0 - exp2Constexpr(-10.0 * i / (EASING_LUT_SIZE - 1));
+    lut.values[i] = (uint16_t)(value * 65536.0 + 0.5);
+  }
+  return lut;
+}
+
+extern const EasingLut EASING_LUT;
+
+// Fase preparada para síntesis (se calcula una vez al entrar en la fase)
+struct PhaseSynth {
+  uint32_t start_us;
+  uint32_t end_us;
+  int32_t delta_us;           // end - start (transiciones)
+  uint32_t progress_step_q24; // Progreso por pulso: 2^24 / (num_pulses - 1)
+  int32_t jitter_q16;         // Amplitud del jitter (fracción del período) en Q16
+  int num_pulses;
+  uint8_t type;
+  uint8_t jitter_type;
+};
+
+inline uint64_t splitmix64(uint64_t x) {
+  uint64_t z = x + 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+void patternSynthIniciarFase(PhaseSynth* synth, const PulsePhase& phase);
+
+// Período sin jitter del pulso i de la fase
+inline uint32_t patternSynthBase(const PhaseSynth* synth, int i) {
+  if (synth->type == PHASE_STABLE) return synth->start_us;
+  if (i >= synth->num_pulses - 1) return (synth->num_pulses > 1) ? synth->end_us : synth->start_us;
+
+  uint32_t progress_q24 = (uint32_t)i * synth->progress_step_q24;
+  uint32_t index = progress_q24 >> (24 - EASING_LUT_BITS);
+  uint32_t frac = progress_q24 & ((1UL << (24 - EASING_LUT_BITS)) - 1);
+  int32_t a = EASING_LUT.values[index];
+  int32_t b = EASING_LUT.values[index + 1];
+  int32_t ease_q16 = a + (int32_t)(((b - a) * (int32_t)frac) >> (24 - EASING_LUT_BITS));
+
+  return (uint32_t)((int32_t)synth->start_us + (int32_t)(((int64_t)synth->delta_us * ease_q16) >> 16));
+}
+
+// Período final (µs) del pulso i de la fase; pulse_number indexa el jitter
+inline uint32_t patternSynthPeriodo(const PhaseSynth* synth, int i, uint32_t pulse_number) {
+  uint32_t base_us = patternSynthBase(synth, i);
+  if (synth->jitter_q16 == 0) return base_us;
+
+  uint64_t r = splitmix64(((uint64_t)PATTERN_SYNTH_SEED << 32) | pulse_number);
+  int32_t factor;  // Q16, en [-1, 1) uniforme o ~N(0, 0.577) acotado a ±2
+  if (synth->jitter_type == JITTER_GAUSSIAN) {
+    factor = (int32_t)((r & 0xFFFF) + ((r >> 16) & 0xFFFF) + ((r >> 32) & 0xFFFF) + (r >> 48)) - 2 * 65536;
+  } else {
+    factor = (int32_t)(r >> 47) - 65536;
+  }
+  // base_us * jitter * factor >> 32 sin pasar de 64 bits (|jitter * factor|
+  // < 2^34, base_us hasta 2^32): base_us por mitades de 16 bits, mismo
+  // redondeo hacia abajo que el producto completo
+  int64_t scaled = (int64_t)synth->jitter_q16 * factor;
+  int64_t low = ((int64_t)(base_us & 0xFFFF) * scaled) >> 16;
+  int64_t variation = ((int64_t)(base_us >> 16) * scaled + low) >> 16;
+  return (uint32_t)((int64_t)base_us + variation);
+}
+
+#endif
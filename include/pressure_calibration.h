@@ -0,0 +1,61 @@
+#ifndef PRESSURE_CALIBRATION_H
+#define PRESSURE_CALIBRATION_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Calibración del sensor de presión: cuentas crudas -> Pa.
+//
+// Tabla de hasta PRESSURE_CAL_MAX_POINTS puntos (cuentas, Pa) ordenados por
+// cuentas, con interpolación lineal por tramos; fuera de la tabla se
+// prolonga el primer o el último tramo. La evaluación es en punto fijo:
+// búsqueda binaria del tramo y pendiente precalculada en Q24 (Pa por
+// cuenta), sin divisiones ni float, para poder aplicarla a tasa completa.
+// Pendientes de más de PRESSURE_CAL_MAX_SLOPE Pa por cuenta se rechazan
+// (no son físicas), y también las
+// negativas: la tabla es no decreciente, así los cuantiles de las cuentas
+// convertidos son los de la presión. Los puntos y las lecturas se acotan a
+// PRESSURE_CAL_MAX_RAW: así la distancia a un punto cabe en 24 bits y el
+// producto por la pendiente en 64; el resultado se satura a int32.
+//
+// Con menos de 2 puntos no hay calibración y se trabaja en cuentas. La
+// tabla y la unidad de pantalla se guardan en NVS con CRC: Preferences en
+// el ESP32 y memoria simulada en host.
+
+enum PressureUnit {
+  PRESSURE_UNIT_KPA,
+  PRESSURE_UNIT_BAR
+};
+
+struct PressureCalPoint {
+  uint32_t raw;
+  int32_t pa;
+};
+
+struct PressureCalibration {
+  int count;
+  PressureCalPoint points[PRESSURE_CAL_MAX_POINTS];  // Cuentas estrictamente crecientes
+  PressureUnit unit;
+};
+
+extern PressureCalibration pressure_calibration;
+
+// Carga la tabla de NVS (llamar una vez al arrancar)
+void calibracionPresionIniciar();
+
+bool calibracionPresionActiva();
+int32_t calibracionPresionPa(uint32_t raw);     // 0 sin calibración
+
+// En la unidad de pantalla si hay calibración; si no, las cuentas
+float calibracionPresionValor(uint32_t raw);
+const char* calibracionPresionNombreUnidad();   // "" sin calibración
+float calibracionPresionPaPorUnidad();         // 1000 (kPa) o 100000 (bar)
+
+// Edición (se guarda en NVS). value en la unidad de pantalla; un punto con
+// las mismas cuentas se sustituye.
+bool calibracionPresionAgregar(uint32_t raw, float value);
+bool calibracionPresionBorrarPunto(int index);
+void calibracionPresionBorrar();
+void calibracionPresionUnidad(PressureUnit unit);
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef PRESSURE_SAMPLER_H
+#define PRESSURE_SAMPLER_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Muestreo de presión a ritmo fijo en una tarea propia.
+//
+// Un timer hardware (PRESSURE_SAMPLER_TIMER; el 0 es del generador) marca
+// cada período y su ISR solo despierta a la tarea de muestreo, fijada al
+// núcleo PRESSURE_SAMPLER_CORE (loop() y la pantalla van en el otro).
+// La lectura va en cadena: en cada período la tarea recoge la conversión
+// pedida en el anterior y pide la siguiente, así que el sensor convierte
+// mientras la tarea duerme y el período mínimo es el de conversión más dos
+// transacciones (pressure_sensor.h). Cada muestra lleva el micros() de su
+// orden de conversión.
+//
+// Dos salidas, ambas anillos SPSC que el loop vacía a su ritmo:
+//   - tasa completa: todas las muestras, para captura y exportación;
+//   - tasa de pantalla: la salida de un decimador CIC (cic_decimator.h) con
+//     el timestamp de la última muestra del bloque. Con factor 1 coincide
+//     con la de tasa completa.
+//
+// Plazos: la ISR cuenta los períodos del timer y la tarea los que atiende;
+// si al despertar hay más de un aviso pendiente, los sobrantes son plazos
+// perdidos (missed). busy_us acumula el tiempo de CPU de la tarea para
+// calcular su carga.
+//
+// El acceso al timer y a FreeRTOS va por una pequeña HAL
+// (pressure_sampler.cpp): hw_timer + tarea en el ESP32 y períodos
+// inyectados en host.
+
+struct PressureSample {
+  uint32_t t_us;               // micros() al enviar la orden de conversión
+  uint32_t raw;
+};
+
+struct PressureSamplerStats {
+  uint32_t ticks;              // Períodos del timer
+  uint32_t samples;            // Muestras correctas (tasa completa)
+  uint32_t outputs;            // Salidas del decimador
+  uint32_t errors;             // Lecturas perdidas (sensor o bus)
+  uint32_t missed;             // Períodos sin atender a tiempo
+  uint32_t overflows;          // Salidas descartadas con el anillo de pantalla lleno
+  uint32_t raw_overflows;      // Muestras descartadas con el anillo de tasa completa lleno
+  uint32_t max_latency_us;     // Retraso máximo timer -> tarea
+  uint32_t max_work_us;        // Duración máxima de un período de trabajo
+  uint32_t busy_us;            // CPU acumulada de la tarea (da la vuelta)
+};
+
+extern volatile PressureSamplerStats pressure_sampler_stats;
+
+// cic_order 1..CIC_MAX_ORDER, decimation 1..CIC_MAX_DECIMATION
+bool muestreoPresionIniciar(uint32_t period_us, int cic_order, int decimation);
+void muestreoPresionDetener();
+bool muestreoPresionActivo();
+
+// Consumidores (loop): false si no hay más muestras
+bool muestreoPresionLeer(PressureSample* sample);          // Tasa de pantalla
+bool muestreoPresionLeerCompleta(PressureSample* sample);  // Tasa completa
+
+#ifndef ARDUINO
+// Sustituto host: interrupción del timer y despertar de la tarea en now_us
+void muestreoPresionHostTimer(uint32_t tick_us);
+void muestreoPresionHostTarea(uint32_t now_us);
+#endif
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef PRESSURE_SENSOR_H
+#define PRESSURE_SENSOR_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Lectura del sensor de presión WNK1MA por I2C en fases, sin esperas.
+//
+// Una lectura son dos transacciones cortas separadas por la conversión:
+//   1. orden de conversión (dirección + WNK1MA_CMD, ~0.2 ms a 100 kHz);
+//   2. espera de WNK1MA_CONVERSION_US fuera del bus: se vuelve a loop();
+//   3. lectura de los 3 bytes (~0.4 ms), en una llamada posterior.
+// Wire en el core Arduino del ESP32 no ofrece aviso de fin de transacción,
+// así que cada fase sigue siendo síncrona, pero breve y acotada por
+// WNK1MA_I2C_TIMEOUT_MS (el timeout por defecto de Wire es de 50 ms).
+//
+// Un fallo (NACK, timeout, bytes que faltan o valor fuera de rango) repite
+// la lectura completa tras WNK1MA_RETRY_DELAY_US, hasta WNK1MA_MAX_RETRIES
+// veces. Agotados los reintentos se recupera el bus (hasta 9 pulsos de SCL
+// para liberar un esclavo que retiene SDA, STOP y reinicio de Wire) y la
+// lectura se da por fallida.
+//
+// El acceso al bus va por una pequeña HAL (pressure_sensor.cpp): Wire en el
+// ESP32 y un sensor simulado en host.
+
+enum PressureSensorState {
+  PRESSURE_SENSOR_IDLE,
+  PRESSURE_SENSOR_CONVERTING,   // Orden enviada, esperando la conversión
+  PRESSURE_SENSOR_RETRY_WAIT,   // Fallo: esperando para repetir la lectura
+  PRESSURE_SENSOR_FAILED        // Reintentos agotados, pendiente de informar
+};
+
+enum PressureSensorResult {
+  PRESSURE_SENSOR_BUSY,         // Sin resultado todavía (o sin lectura en curso)
+  PRESSURE_SENSOR_OK,
+  PRESSURE_SENSOR_ERROR
+};
+
+struct PressureSensorStats {
+  uint32_t readings;            // Lecturas correctas
+  uint32_t errors;              // Transacciones fallidas (incluye reintentos)
+  uint32_t retries;
+  uint32_t recoveries;          // Recuperaciones del bus
+  uint32_t failures;            // Lecturas perdidas tras agotar los reintentos
+  uint32_t max_busy_us;         // Transacción más larga (bloqueo máximo de loop)
+};
+
+extern PressureSensorStats pressure_sensor_stats;
+
+// Configura el bus I2C (llamar al arrancar y al entrar en PRESSURE)
+void sensorPresionIniciar();
+
+// Reloj del bus (I2C_CLOCK_HZ o I2C_FAST_CLOCK_HZ); se mantiene tras una
+// recuperación. Descarta la lectura en curso.
+void sensorPresionReloj(uint32_t clock_hz);
+
+// Envía la orden de conversión; false si ya hay una lectura en curso
+bool sensorPresionSolicitar(uint32_t now_us);
+
+// Avanza la lectura en curso; con PRESSURE_SENSOR_OK deja el valor en *raw
+PressureSensorResult sensorPresionServicio(uint32_t now_us, uint32_t* raw);
+
+PressureSensorState sensorPresionEstado();
+
+// micros() de la orden de conversión de la lectura en curso o de la última
+// entregada (tras un reintento, la del reintento)
+uint32_t sensorPresionInicioUs();
+
+#ifndef ARDUINO
+// Sustituto host: valor del sensor y transacciones que van a fallar
+void sensorPresionHostValor(uint32_t raw);
+void sensorPresionHostFallos(int write_failures, int read_failures);
+#endif
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef PRESSURE_TRIGGER_H
+#define PRESSURE_TRIGGER_H
+
+#include <stdint.h>
+#include "config.h"
+#include "pressure_sampler.h"
+
+// Captura de transitorios de presión por disparo, como un osciloscopio.
+//
+// Se evalúa sobre el flujo a tasa completa (pressure_sampler.h), muestra a
+// muestra y en O(1). La captura en curso es un anillo de pre + post
+// muestras dentro del propio hueco: mientras espera el disparo da vueltas
+// con las últimas, y tras el disparo se añaden post - 1 muestras más y el
+// hueco queda congelado tal cual, sin copiar nada. Los huecos
+// (PRESSURE_CAPTURE_SLOTS) se reutilizan en orden, el más viejo primero.
+// Después de cada captura hay que volver a llenar las pre muestras antes de
+// rearmar.
+//
+// Disparos (con flanco de subida, bajada o ambos):
+//   - nivel: la presión cruza threshold;
+//   - salto: la presión cambia threshold en span muestras;
+//   - dP/dt: la derivada (media exponencial de PRESSURE_TRIGGER_RATE_SMOOTH
+//     muestras, por segundo) cruza threshold;
+//   - pulso: flanco de subida en PRESSURE_TRIGGER_PIN; dispara la primera
+//     muestra pedida a partir del pulso, y la ventana queda centrada en él.
+// Un cruce dispara solo si antes la magnitud estuvo por debajo del umbral
+// menos la histéresis, así el ruido sobre el umbral no dispara de nuevo.
+//
+// Los umbrales van en Pa con calibración y en cuentas sin ella (se fija al
+// configurar). Si la calibración se activa o se desactiva, el disparo se
+// desarma.
+
+enum PressureTriggerMode {
+  PRESSURE_TRIGGER_LEVEL,
+  PRESSURE_TRIGGER_SLOPE,
+  PRESSURE_TRIGGER_RATE,
+  PRESSURE_TRIGGER_PULSE
+};
+
+enum PressureTriggerEdge {
+  PRESSURE_EDGE_RISE,
+  PRESSURE_EDGE_FALL,
+  PRESSURE_EDGE_BOTH
+};
+
+enum PressureCaptureState {
+  PRESSURE_CAPTURE_IDLE,       // Desarmado
+  PRESSURE_CAPTURE_FILLING,    // Llenando las muestras previas
+  PRESSURE_CAPTURE_ARMED,      // Esperando el disparo
+  PRESSURE_CAPTURE_POST        // Disparado, completando las posteriores
+};
+
+struct PressureTriggerConfig {
+  PressureTriggerMode mode;
+  PressureTriggerEdge edge;
+  float threshold;             // Nivel, salto o unidades por segundo (Pa o cuentas)
+  float hysteresis;
+  int span;                    // Salto: muestras (1..PRESSURE_TRIGGER_SLOPE_MAX)
+  int pre;                     // Muestras antes del disparo
+  int post;                    // Desde el disparo, incluido (pre + post <= PRESSURE_CAPTURE_MAX)
+  bool single;                 // Desarmar tras una captura
+  bool calibrated;             // Umbrales en Pa (true) o en cuentas
+};
+
+struct PressureTriggerStats {
+  uint32_t triggers;
+  uint32_t pulses;             // Pulsos externos recibidos
+  uint32_t pulses_ignored;     // Llegados sin estar armado
+  uint32_t pulse_overflows;
+};
+
+struct PressureCapture {
+  bool valid;
+  uint32_t seq;                // Número de captura (1, 2, ...)
+  PressureTriggerMode mode;
+  uint32_t trigger_t_us;       // Pulso externo o muestra que disparó
+  int pre;                     // Índice de la muestra del disparo
+  int length;
+  int start;                   // Posición de la muestra más antigua
+  PressureSample samples[PRESSURE_CAPTURE_MAX];
+};
+
+// Envolvente min/max por columna de una captura, en la unidad de pantalla
+struct PressureCaptureView {
+  float value_min[GRAPH_WIDTH];
+  float value_max[GRAPH_WIDTH];
+  int width;
+  int trigger_x;               // Columna del disparo (-1 si queda fuera)
+  float scale_min;
+  float scale_max;
+  int32_t first_us;            // Extremos de la vista respecto al disparo
+  int32_t last_us;
+};
+
+extern PressureTriggerConfig pressure_trigger_config;
+extern PressureTriggerStats pressure_trigger_stats;
+
+// Valida, guarda y arma; false si algún valor está fuera de rango
+bool disparoPresionConfigurar(const PressureTriggerConfig& config);
+void disparoPresionArmar();
+void disparoPresionDetener();
+PressureCaptureState disparoPresionEstado();
+
+// Una muestra a tasa completa (loop, al vaciar el anillo)
+void disparoPresionAgregar(const PressureSample& sample);
+
+// age 0 = la última; nullptr si no hay
+const PressureCapture* disparoPresionCaptura(int age);
+PressureSample capturaPresionMuestra(const PressureCapture* capture, int index);
+
+// zoom 1..PRESSURE_CAPTURE_MAX_ZOOM: 1/zoom de la captura, centrada en el disparo
+void capturaPresionVista(const PressureCapture* capture, int zoom, PressureCaptureView* view);
+
+#ifndef ARDUINO
+// Sustituto host: flanco en el pin del pulso externo en t_us
+void disparoPresionHostPulso(uint32_t t_us);
+#endif
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef PULSE_CAPTURE_H
+#define PULSE_CAPTURE_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Captura de flancos de subida con timestamp.
+//
+// La ISR del pin de captura toma el reloj del motor de pulsos
+// (pulseOutputAhoraUs) y lo deja en un anillo SPSC; el loop lo vacía. Así
+// los flancos generados y los capturados comparten base de tiempo.
+
+extern volatile uint32_t pulse_capture_overflows;  // Flancos perdidos con el anillo lleno
+
+void pulseCaptureIniciar(uint8_t pin);
+void pulseCaptureDetener();
+bool pulseCaptureLeer(uint32_t* t_us);   // Solo desde el loop
+int pulseCapturePendientes();
+
+#ifndef ARDUINO
+// Sustituto host: la "ISR" la llama el test con el timestamp simulado
+void pulseCaptureHostRegistrar(uint32_t t_us);
+#endif
+
+#endif
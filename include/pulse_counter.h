@@ -0,0 +1,32 @@
+#ifndef PULSE_COUNTER_H
+#define PULSE_COUNTER_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Cuenta de flancos de subida con el periférico PCNT del ESP32.
+//
+// El hardware cuenta sin interrumpir a la CPU por flanco y filtra glitches
+// más cortos que filter_ns (el filtro cuenta ciclos APB: máximo 1023 ciclos,
+// ~12.8 µs; rebotes de milisegundos no se filtran aquí). El contador de 16
+// bits vuelve a 0 al llegar a PULSE_COUNTER_LIMIT y dispara una interrupción
+// que suma una vuelta: la cuenta total se extiende por software a 64 bits.
+//
+// El acceso al periférico va por una pequeña HAL (pulse_counter.cpp): unidad
+// PCNT en el ESP32 y un contador simulado en host.
+
+extern volatile uint32_t pulse_counter_wraps;  // Vueltas del contador hardware
+
+bool pulseCounterIniciar(uint8_t pin, uint32_t filter_ns);
+void pulseCounterDetener();
+bool pulseCounterActivo();
+uint64_t pulseCounterLeer();   // Flancos desde pulseCounterIniciar (monótono)
+
+#ifndef ARDUINO
+// Sustituto host: flancos que "ve" el hardware. Las vueltas quedan pendientes
+// hasta pulseCounterHostAtenderIsr(), para simular la latencia de la ISR.
+void pulseCounterHostFlancos(uint32_t count);
+void pulseCounterHostAtenderIsr();
+#endif
+
+#endif
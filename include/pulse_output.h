@@ -0,0 +1,95 @@
+#ifndef PULSE_OUTPUT_H
+#define PULSE_OUTPUT_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Motor de reproducción de pulsos temporizado por hardware.
+//
+// El loop encola períodos (µs) en un anillo SPSC por canal y el motor emite
+// los flancos desde la alarma de un timer hardware: el jitter ya no depende
+// de la latencia del loop (redibujado de pantalla, botones...).
+//
+// Cada canal tiene su GPIO y su anillo. Todos comparten un único timer: los
+// deadlines del próximo flanco de cada canal viven en un min-heap
+// (edge_heap.h) y la alarma se arma siempre al más próximo, así que añadir
+// canales no multiplica el coste por flanco.
+//
+// Cada pulso es un flanco de subida seguido de un HIGH de PULSE_HIGH_US. Los
+// flancos de subida se anclan a la línea de tiempo planificada (origen común
+// + suma de períodos): los retrasos no se acumulan. Si un flanco llega tarde,
+// la política de recuperación decide cómo volver a la línea de tiempo.
+//
+// En ESP32 (ARDUINO definido) usa el timer PULSE_OUTPUT_TIMER a 1 MHz.
+// En host se compila un sustituto con reloj simulado que registra los flancos,
+// para comparar sus timestamps con los períodos planificados.
+
+enum PulseCatchupPolicy {
+  CATCHUP_EMIT_LATE,  // Emitir tarde; los siguientes salen a su hora (ráfaga si hace falta)
+  CATCHUP_SKIP,       // Descartar los pulsos cuyo sucesor ya debería haber salido
+  CATCHUP_COMPRESS    // Acortar los períodos siguientes hasta recuperar el retraso
+};
+
+// Estadísticas de un canal (las escribe el motor)
+struct PulseOutputChannelStats {
+  uint32_t emitted;            // Pulsos emitidos desde iniciar
+  uint32_t underruns;          // Veces que el anillo estaba vacío
+  uint64_t last_rise_us;       // Timestamp del último flanco
+  uint32_t last_real_us;       // Período real medido (flanco a flanco)
+  uint32_t last_planned_us;    // Período planificado anterior
+  int32_t last_error_us;       // Retraso del flanco respecto a su deadline
+  uint32_t current_period_us;  // Período en curso (tras el último flanco)
+  uint32_t skipped;            // Pulsos descartados por CATCHUP_SKIP
+  int32_t drift_us;            // Deriva acumulada: último flanco real - planificado
+  int32_t max_drift_us;
+};
+
+extern volatile PulseOutputChannelStats pulse_output_stats[PULSE_OUTPUT_MAX_CHANNELS];
+
+// Skew entre canales: diferencia entre el canal más adelantado y el más
+// retrasado respecto a sus líneas de tiempo planificadas (mismo origen)
+extern volatile uint32_t pulse_output_skew_us;
+extern volatile uint32_t pulse_output_max_skew_us;
+
+// Ciclo de vida (todos los canales arrancan a la vez, con origen común)
+void pulseOutputBegin(const uint8_t* pins, int channel_count);
+void pulseOutputIniciar();
+void pulseOutputDetener();
+bool pulseOutputActivo();
+bool pulseOutputTerminado();   // Todos los canales han terminado
+int pulseOutputNumCanales();
+
+// Política de recuperación (se aplica en caliente)
+void pulseOutputPoliticaRecuperacion(PulseCatchupPolicy policy);
+PulseCatchupPolicy pulseOutputObtenerPolitica();
+const char* pulseOutputNombrePolitica(PulseCatchupPolicy policy);
+
+// Por canal (solo desde el loop)
+bool pulseOutputEncolar(int channel, uint32_t period_us);
+int pulseOutputEspacioLibre(int channel);
+void pulseOutputCerrarFlujo(int channel);   // No llegarán más períodos: terminar al vaciar el anillo
+bool pulseOutputCanalTerminado(int channel);
+
+// Reloj del motor en µs (también desde ISR: base de tiempo de la captura)
+uint64_t pulseOutputAhoraUs();
+
+#ifdef ARDUINO
+void pulseOutputImprimirCanales();
+#else
+// Sustituto host: reloj simulado y registro de flancos
+struct PulseOutputHostEdge {
+  uint64_t t_us;
+  uint8_t channel;
+  uint8_t level;
+};
+
+#define PULSE_OUTPUT_HOST_MAX_EDGES 4096
+
+extern PulseOutputHostEdge pulse_output_host_edges[PULSE_OUTPUT_HOST_MAX_EDGES];
+extern int pulse_output_host_edge_count;
+extern uint32_t pulse_output_host_latency_us;  // Latencia simulada de la ISR
+
+void pulseOutputHostAvanzar(uint64_t hasta_us);
+#endif
+
+#endif
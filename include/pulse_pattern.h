@@ -0,0 +1,213 @@
+#ifndef PULSE_PATTERN_H
+#define PULSE_PATTERN_H
+
+#include <stdint.h>
+#include "config.h"
+#include "pattern_codec.h"
+
+// Tipos y generación de patrones de pulsos.
+//
+// Nada de este header depende de Arduino. Los generadores son constexpr: el
+// mismo código genera las tablas en tiempo de compilación (flash), calcula
+// períodos bajo demanda en runtime y sirve de referencia en host.
+
+enum TestCase {
+  TEST_CASE_1,
+  TEST_CASE_2,
+  TEST_CASE_3,
+  TEST_CASE_4,
+  TEST_CASE_5,
+  TEST_CASE_9
+};
+
+constexpr int NUM_TEST_CASES = 6;
+
+enum PhaseType {
+  PHASE_TRANSITION,  // Cambio progresivo de tempo
+  PHASE_STABLE       // Tempo constante
+};
+
+enum JitterType {
+  JITTER_UNIFORM,    // ±jitter_percent
+  JITTER_GAUSSIAN    // σ = jitter_percent / 2 (solo sintetizador en punto fijo)
+};
+
+struct PulsePhase {
+  PhaseType type;
+  float tempo_start_ms;   // Tiempo entre pulsos al inicio (ms)
+  float tempo_end_ms;     // Tiempo entre pulsos al final (ms)
+  int num_pulses;         // Número de pulsos a generar en esta fase
+  float jitter_percent;   // % de variación aleatoria
+  JitterType jitter_type = JITTER_UNIFORM;  // Opcional
+};
+
+// Patrón generado en RAM (generador runtime de referencia)
+struct PulsePattern {
+  float periods[MAX_PULSES];
+  int count;
+};
+
+// Vista de un patrón ya generado (tablas en flash)
+struct PatternTable {
+  const uint8_t* data;       // Períodos en µs codificados (pattern_codec.h)
+  uint32_t data_size;
+  int count;
+  uint32_t total_ms;
+};
+
+// Datos de una tabla generada en compilación
+template <int N>
+struct PatternPeriodsUs {
+  uint32_t periods_us[N];
+};
+
+template <int B>
+struct PatternTableData {
+  uint8_t data[B];
+  int count;
+  uint32_t total_ms;
+};
+
+// 2^x para x <= 0 evaluable en compilación (pow() no es constexpr).
+// Reducción a 2^floor(x) * e^(frac*ln2) con serie de Taylor: error de pocos
+// ulp en double, invisible tras redondear a float.
+constexpr double exp2Constexpr(double x) {
+  double scale = 1.0;
+  while (x < 0.0) {
+    x += 1.0;
+    scale *= 0.5;
+  }
+  double z = x * 0.69314718055994530942;
+  double term = 1.0;
+  double sum = 1.0;
+  for (int k = 1; k < 30; k++) {
+    term *= z / k;
+    sum += term;
+  }
+  return sum * scale;
+}
+
+// Easing exponencial de las fases de transición (equivale a 1 - pow(2, -10p))
+constexpr float easingTransicion(float progress) {
+  return (progress == 1.0f) ? 1.0f : (float)(1.0 - exp2Constexpr(-10.0 * progress));
+}
+
+constexpr float aplicarJitter(float tempo, float jitter_percent, unsigned long pulse_number) {
+  if (jitter_percent <= 0.0f) return tempo;
+
+  // LCG de 31 bits: el resultado no depende del ancho de unsigned long
+  unsigned long random_val = (pulse_number * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+  float factor = (float)(((random_val % 2000) / 1000.0) - 1.0);
+  float variation = (float)(tempo * (jitter_percent / 100.0) * factor);
+  return tempo + variation;
+}
+
+// Tempo base (ms, sin jitter) del pulso i dentro de su fase
+constexpr float calcularTempoFase(const PulsePhase& phase, int i) {
+  if (phase.type == PHASE_STABLE) {
+    return phase.tempo_start_ms;
+  }
+  float progress = (phase.num_pulses > 1) ? (float)i / (float)(phase.num_pulses - 1) : 0.0f;
+  return phase.tempo_start_ms + (phase.tempo_end_ms - phase.tempo_start_ms) * easingTransicion(progress);
+}
+
+// Período en µs tal y como lo reproduce el generador
+constexpr uint32_t calcularPeriodoUs(const PulsePhase& phase, int i, unsigned long pulse_number) {
+  return (uint32_t)(aplicarJitter(calcularTempoFase(phase, i), phase.jitter_percent, pulse_number) * 1000.0);
+}
+
+template <int NP>
+constexpr int contarPulsosFases(const PulsePhase (&phases)[NP]) {
+  int total = 0;
+  for (int p = 0; p < NP; p++) {
+    total += phases[p].num_pulses;
+  }
+  return (total < MAX_PULSES) ? total : MAX_PULSES;
+}
+
+template <int N, int NP>
+constexpr PatternPeriodsUs<N> generarPeriodosUs(const PulsePhase (&phases)[NP]) {
+  PatternPeriodsUs<N> result{};
+  int count = 0;
+  for (int p = 0; p < NP && count < N; p++) {
+    for (int i = 0; i < phases[p].num_pulses && count < N; i++) {
+      result.periods_us[count] = calcularPeriodoUs(phases[p], i, count);
+      count++;
+    }
+  }
+  return result;
+}
+
+template <int N>
+constexpr int tamanoCompacto(const PatternPeriodsUs<N>& periods) {
+  int size = 0;
+  uint32_t previous_us = 0;
+  for (int i = 0; i < N; i++) {
+    size += periodoLongitudCodificada(previous_us, periods.periods_us[i]);
+    previous_us = periods.periods_us[i];
+  }
+  return size;
+}
+
+// Codifica los períodos (la vista previa se calcula al cargar: pattern_preview.h)
+template <int B, int N>
+constexpr PatternTableData<B> generarTablaPatron(const PatternPeriodsUs<N>& periods) {
+  PatternTableData<B> table{};
+  int pos = 0;
+  uint32_t previous_us = 0;
+  uint64_t total_us = 0;
+
+  for (int i = 0; i < N; i++) {
+    uint32_t period_us = periods.periods_us[i];
+    pos += varintEscribir(table.data + pos, zigzagCodificar((int32_t)(period_us - previous_us)));
+    previous_us = period_us;
+    total_us += period_us;
+  }
+
+  table.count = N;
+  table.total_ms = (uint32_t)(total_us / 1000);
+  return table;
+}
+
+// Sintetizador en punto fijo (usa PulsePhase y exp2Constexpr de arriba)
+#include "pattern_synth.h"
+
+// Iterador de períodos: recorre una tabla o calcula cada período bajo demanda
+// a partir de la lista de fases con el sintetizador en punto fijo (memoria
+// O(1), sin límite de MAX_PULSES)
+enum PatternSourceType {
+  PATTERN_SOURCE_TABLE,
+  PATTERN_SOURCE_PHASES,
+  PATTERN_SOURCE_FILE       // Fichero de períodos leído por bloques (pattern_file.h)
+};
+
+struct PatternFileReader;
+
+struct PatternStream {
+  PatternSourceType source;
+  PatternTable table;          // PATTERN_SOURCE_TABLE
+  PeriodDecoder decoder;
+  const PulsePhase* phases;    // PATTERN_SOURCE_PHASES
+  int phase_count;
+  int phase_index;
+  int pulse_in_phase;
+  PhaseSynth synth;            // Fase phase_index preparada para síntesis
+  int synth_phase;
+  unsigned long pulse_number;  // Índice global (posición en tabla / semilla del jitter)
+  PatternFileReader* file;     // PATTERN_SOURCE_FILE
+};
+
+void patternStreamDesdeTabla(PatternStream* stream, const PatternTable& table);
+void patternStreamDesdeFases(PatternStream* stream, const PulsePhase* phases, int phase_count);
+void patternStreamReiniciar(PatternStream* stream);
+bool patternStreamSiguiente(PatternStream* stream, uint32_t* period_us);
+void patternStreamRellenar(PatternStream* stream);  // Precarga de ficheros (fuera del camino crítico)
+int patternStreamLongitud(const PatternStream* stream);  // Pulsos totales (sin recorrerlo)
+
+// Tablas de TC1-TC5 generadas en compilación (src/pattern_tables.cpp)
+PatternTable obtenerTablaPatron(TestCase tc);
+
+// Abre el patrón de un test case: tabla en flash o fases bajo demanda
+bool abrirPatron(TestCase tc, PatternStream* stream);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef PULSE_TELEMETRY_H
+#define PULSE_TELEMETRY_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Telemetría por pulso del generador.
+//
+// El motor de pulsos registra cada flanco de subida (timestamp, período
+// planificado, período real y error) en un anillo fijo en RAM desde su ISR:
+// coste O(1) y sin E/S. El resumen y el volcado se imprimen desde el loop
+// cuando se piden. El pulso 1 no tiene período previo: solo aporta timestamp.
+
+struct PulseTelemetryRecord {
+  uint32_t seq;          // Número de pulso (1 = primer pulso del patrón)
+  uint32_t planned_us;   // Período planificado que precede a este pulso
+  uint32_t real_us;      // Período real medido flanco a flanco
+  int32_t error_us;      // real - planificado
+  uint32_t rise_us;      // Timestamp del flanco de subida (reloj del motor, 32 bits bajos)
+};
+
+struct PulseTelemetrySummary {
+  uint32_t count;
+  int64_t sum_error_us;
+  uint32_t max_abs_error_us;
+  uint32_t late_count;
+  uint32_t histogram[PULSE_TELEMETRY_HIST_BINS];
+};
+
+extern const uint32_t PULSE_TELEMETRY_HIST_LIMITS_US[PULSE_TELEMETRY_HIST_BINS - 1];
+
+void pulseTelemetryReset();
+void pulseTelemetryRegistrar(uint32_t seq, uint32_t planned_us, uint32_t real_us, uint32_t rise_us);
+bool pulseTelemetryLeer(uint32_t seq, PulseTelemetryRecord* out);
+uint32_t pulseTelemetryUltimoSeq();
+void pulseTelemetryObtenerResumen(PulseTelemetrySummary* out);
+
+#ifdef ARDUINO
+void pulseTelemetryImprimirResumen();
+void pulseTelemetryVolcar();
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Cuantiles en memoria fija sobre una ventana deslizante (períodos entre
+// pulsos en µs, presión en cuentas del sensor).
+//
+// Histograma logarítmico al estilo HDR: los valores menores que
+// 2^QUANTILE_SUB_BITS van en cubetas exactas y el resto en
+// 2^QUANTILE_SUB_BITS cubetas por octava, así que un cuantil se devuelve con
+// un error relativo de ±1/2^(QUANTILE_SUB_BITS+1) (±3% con 4 bits) como
+// mucho. Los valores desde 2^QUANTILE_MAX_BITS van a una cubeta de desborde
+// aparte, abierta por arriba (QUANTILE_OVERFLOW_BUCKET); el máximo se guarda
+// exacto aparte.
+//
+// La ventana se reparte en QUANTILE_WINDOW_SLOTS sub-histogramas: cada
+// muestra suma en el actual y en el total (O(1)), y al cambiar de
+// sub-histograma el más viejo se resta del total y se vacía. La ventana
+// cubre por tanto entre (SLOTS-1)/SLOTS y 1 vez window_ms. Con window_ms = 0
+// no hay ventana: el total acumula desde el inicio.
+//
+// Los sub-histogramas cuentan en 16 bits: con ventanas de hasta una hora y
+// tasas por debajo de ~140 muestras/s no se saturan. Si una cubeta se satura,
+// la muestra se cuenta en `saturated` y no entra en el total.
+
+#define QUANTILE_OVERFLOW_BUCKET ((QUANTILE_MAX_BITS - QUANTILE_SUB_BITS + 1) << QUANTILE_SUB_BITS)
+#define QUANTILE_BUCKETS (QUANTILE_OVERFLOW_BUCKET + 1)
+
+struct QuantileSummary {
+  uint32_t count;
+  uint32_t p50;
+  uint32_t p90;
+  uint32_t p99;
+  uint32_t max;
+};
+
+struct QuantileSketch {
+  uint32_t window_ms;
+  uint32_t slot_ms;
+  uint32_t slot_start_ms;
+  int slot;
+  uint16_t slots[QUANTILE_WINDOW_SLOTS][QUANTILE_BUCKETS];
+  uint32_t slot_count[QUANTILE_WINDOW_SLOTS];
+  uint32_t slot_max[QUANTILE_WINDOW_SLOTS];
+  uint32_t total[QUANTILE_BUCKETS];
+  uint32_t count;
+  uint32_t saturated;
+};
+
+void cuantilesIniciar(QuantileSketch* sketch, uint32_t window_ms, uint32_t now_ms);
+void cuantilesAgregar(QuantileSketch* sketch, uint32_t value, uint32_t now_ms);
+void cuantilesResumen(QuantileSketch* sketch, uint32_t now_ms, QuantileSummary* summary);
+
+// Cubetas (para volcados): índice de un valor y rango [low, high] que cubre.
+// La de desborde devuelve high = UINT32_MAX y false (sin límite superior).
+int cuantilesIndice(uint32_t value);
+bool cuantilesRangoCubeta(int index, uint32_t* low, uint32_t* high);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef SERIAL_CMD_H
+#define SERIAL_CMD_H
+
+#include "common.h"
+
+// Comandos por puerto serie (una línea terminada en '\n')
+void procesarComandosSerial();
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef SLIDING_EXTREMA_H
+#define SLIDING_EXTREMA_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Mínimo y máximo de una ventana deslizante con dos colas monótonas.
+//
+// La cola del máximo guarda valores estrictamente decrecientes (al entrar
+// uno nuevo se sacan por detrás los que no lo superan) y la del mínimo
+// estrictamente crecientes; el extremo de la ventana es siempre el primero
+// de cada cola, y por delante salen los que caducan. Cada valor entra y sale
+// una vez: O(1) amortizado por muestra, sin recorrer la ventana.
+//
+// Dos tipos de ventana:
+//   - por muestras: las últimas window (<= SLIDING_EXTREMA_CAPACITY), exacta;
+//   - por tiempo: los últimos window ms. Las muestras se agrupan en
+//     SLIDING_EXTREMA_BLOCKS bloques de window / BLOCKS ms y las colas
+//     guardan el mínimo y el máximo de cada bloque, así la memoria no
+//     depende de la tasa; un bloque caduca entero, con lo que la ventana
+//     llega a cubrir hasta un bloque de más.
+// Las colas son anillos de tamaño fijo.
+
+struct ExtremaEntry {
+  float value;
+  uint32_t stamp;              // Número de muestra o inicio del bloque (ms)
+};
+
+struct ExtremaQueue {
+  ExtremaEntry entries[SLIDING_EXTREMA_CAPACITY];
+  int head;
+  int count;
+};
+
+struct SlidingExtrema {
+  bool by_time;
+  uint32_t window;             // Muestras o ms
+  uint32_t block_ms;           // Solo por tiempo
+  uint32_t samples;            // Muestras agregadas
+  ExtremaQueue max_queue;
+  ExtremaQueue min_queue;
+  bool block_open;             // Bloque en curso, todavía fuera de las colas
+  uint32_t block_start;
+  float block_min;
+  float block_max;
+};
+
+// false si window está fuera de rango (1..SLIDING_EXTREMA_CAPACITY muestras
+// o al menos SLIDING_EXTREMA_BLOCKS ms)
+bool extremosIniciarMuestras(SlidingExtrema* ext, uint32_t window_samples);
+bool extremosIniciarTiempo(SlidingExtrema* ext, uint32_t window_ms);
+void extremosVaciar(SlidingExtrema* ext);
+
+void extremosAgregar(SlidingExtrema* ext, float value, uint32_t now_ms);
+
+// false si la ventana está vacía
+bool extremosLeer(SlidingExtrema* ext, uint32_t now_ms, float* min_value, float* max_value);
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef TEST_CASES_H
+#define TEST_CASES_H
+
+#include "pulse_pattern.h"
+
+// Arrays de fases para cada test case (constexpr: se usan para generar las
+// tablas de períodos en tiempo de compilación)
+
+// TC1: Arranque/Parada Rápidos (~1.5s)
+constexpr PulsePhase test1_phases[] = {
+  {PHASE_TRANSITION, 75.0, 43.0, 4, 3.0},   // Aceleración: 75→43ms, 4 pulsos
+  {PHASE_TRANSITION, 43.0, 90.0, 5, 3.0}    // Frenado: 43→90ms, 5 pulsos
+};
+
+// TC2: Normal - Arranque-Estable-Parada (~6s)
+constexpr PulsePhase test2_phases[] = {
+  {PHASE_TRANSITION, 81.0, 48.0, 10, 3.0},  // Aceleración: 81→48ms, 10 pulsos
+  {PHASE_STABLE, 49.0, 49.0, 60, 4.0},      // Estable: 49ms, 60 pulsos (~3s)
+  {PHASE_TRANSITION, 49.0, 97.0, 15, 3.0}   // Frenado: 49→97ms, 15 pulsos
+};
+
+// TC3: Evento Compuesto - Grifo Adicional (~8.5s)
+constexpr PulsePhase test3_phases[] = {
+  {PHASE_TRANSITION, 73.0, 53.0, 8, 3.0},   // Aceleración inicial: 73→53ms
+  {PHASE_STABLE, 53.0, 53.0, 28, 4.0},      // Flujo bajo: 53ms, 28 pulsos
+  {PHASE_TRANSITION, 53.0, 28.0, 8, 3.0},   // Aceleración: 53→28ms (se abre más)
+  {PHASE_STABLE, 28.0, 28.0, 71, 4.0},      // Flujo alto: 28ms, 71 pulsos (~2s)
+  {PHASE_TRANSITION, 28.0, 55.0, 10, 3.0},  // Desaceleración: 28→55ms (cierra grifo)
+  {PHASE_STABLE, 55.0, 55.0, 27, 4.0},      // Flujo bajo: 55ms, 27 pulsos
+  {PHASE_TRANSITION, 55.0, 100.0, 12, 3.0}  // Frenado final: 55→100ms
+};
+
+// TC4: Stress Test - Flujo MUY Alto (~15s)
+constexpr PulsePhase test4_phases[] = {
+  {PHASE_TRANSITION, 65.0, 23.0, 8, 3.0},   // Aceleración rápida: 65→23ms
+  {PHASE_STABLE, 23.0, 23.0, 543, 4.0},     // Flujo altísimo: 23ms, 543 pulsos (~12.5s)
+  {PHASE_TRANSITION, 23.0, 80.0, 15, 3.0}   // Frenado: 23→80ms
+};
+
+// TC5: Pulsos Aislados - Fugas (~13s)
+constexpr PulsePhase test5_phases[] = {
+  {PHASE_STABLE, 2550.0, 2550.0, 4, 0},     // 4 pulsos separados 2.55s
+  {PHASE_STABLE, 3050.0, 3050.0, 1, 0}      // Último pulso con pausa mayor
+};
+
+// TC9: Escenario Completo - Uso doméstico realista (~271s, ~6350 pulsos)
+// Supera MAX_PULSES: no tiene tabla, se genera bajo demanda
+constexpr PulsePhase test9_phases[] = {
+  // FASE 1: Apertura total (0-62s)
+  {PHASE_TRANSITION, PERIOD_F5, PERIOD_F2, 7, 3.0},    // Arranque: 133→39ms
+  {PHASE_TRANSITION, PERIOD_F2, PERIOD_F1, 10, 3.0},   // Aceleración: 39→23ms
+  {PHASE_STABLE, PERIOD_F1, PERIOD_F1, 2608, 4.0},     // Flujo máximo sostenido: 23ms (60s)
+  {PHASE_TRANSITION, PERIOD_F1, PERIOD_F2, 25, 3.0},   // Desaceleración: 23→39ms
+  {PHASE_TRANSITION, PERIOD_F2, PERIOD_F5, 2, 3.0},    // Parada gradual: 39→133ms
+  {PHASE_STABLE, 5000.0, 5000.0, 1, 0},                // PAUSA 1: 5s sin pulsos
+  // FASE 2: Apertura parcial (67-255s)
+  {PHASE_TRANSITION, PERIOD_F5, PERIOD_F3, 23, 3.0},   // Arranque suave: 133→50ms
+  {PHASE_STABLE, PERIOD_F3, PERIOD_F3, 3640, 4.0},     // Flujo medio sostenido: 50ms (182s)
+  {PHASE_TRANSITION, PERIOD_F3, PERIOD_F5, 30, 3.0},   // Parada gradual: 50→133ms
+  {PHASE_STABLE, 12000.0, 12000.0, 1, 0},              // PAUSA 2: 12s sin pulsos
+  {PHASE_STABLE, PERIOD_F2, PERIOD_F2, 1, 0}           // Microfuga: pulso aislado
+};
+
+const PulsePhase* getTestPhases(TestCase tc, int* phase_count);
+
+#endif
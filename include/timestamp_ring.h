@@ -0,0 +1,74 @@
+#ifndef TIMESTAMP_RING_H
+#define TIMESTAMP_RING_H
+
+#include <stdint.h>
+
+// Anillo SPSC de timestamps (µs) entre una ISR y el loop.
+//
+// La ISR es el único productor (escribe head) y el loop el único consumidor
+// (escribe tail): no hace falta sección crítica. Los índices crecen sin
+// límite y se enmascaran al acceder, así lleno/vacío se distinguen sin
+// perder una posición. Con el anillo lleno el timestamp se descarta y se
+// cuenta en overflows, y el siguiente que entra lleva la marca de hueco:
+// el consumidor sabe así en qué entrada exacta falta algo delante, después
+// de vaciar las que ya estaban en cola. Las funciones son inline para que la ISR no salte a
+// flash; el anillo debe ser una variable global o static (RAM interna).
+
+template <int N>
+struct TimestampRing {
+  static_assert((N & (N - 1)) == 0, "el tamaño del anillo debe ser potencia de 2");
+  volatile uint32_t data[N];
+  volatile uint8_t gaps[N];        // 1: se perdieron timestamps justo antes
+  volatile uint32_t head;
+  volatile uint32_t tail;
+  volatile uint32_t overflows;
+  volatile bool gap_pending;       // Solo productor: marcar la próxima entrada
+};
+
+template <int N>
+inline void timestampRingVaciar(TimestampRing<N>* ring) {
+  ring->head = 0;
+  ring->tail = 0;
+  ring->overflows = 0;
+  ring->gap_pending = false;
+}
+
+// Productor (ISR)
+template <int N>
+inline bool timestampRingInsertar(TimestampRing<N>* ring, uint32_t t_us) {
+  uint32_t head = ring->head;
+  if (head - ring->tail >= (uint32_t)N) {
+    ring->overflows++;
+    ring->gap_pending = true;
+    return false;
+  }
+  ring->data[head & (N - 1)] = t_us;
+  ring->gaps[head & (N - 1)] = ring->gap_pending ? 1 : 0;
+  ring->gap_pending = false;
+  ring->head = head + 1;
+  return true;
+}
+
+// Consumidor (loop); gap = true si se perdieron timestamps antes de este
+template <int N>
+inline bool timestampRingLeer(TimestampRing<N>* ring, uint32_t* t_us, bool* gap) {
+  uint32_t tail = ring->tail;
+  if (tail == ring->head) return false;
+  *t_us = ring->data[tail & (N - 1)];
+  *gap = ring->gaps[tail & (N - 1)] != 0;
+  ring->tail = tail + 1;
+  return true;
+}
+
+template <int N>
+inline bool timestampRingLeer(TimestampRing<N>* ring, uint32_t* t_us) {
+  bool gap;
+  return timestampRingLeer(ring, t_us, &gap);
+}
+
+template <int N>
+inline int timestampRingPendientes(const TimestampRing<N>* ring) {
+  return (int)(ring->head - ring->tail);
+}
+
+#endif
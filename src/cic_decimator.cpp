@@ -0,0 +1,47 @@
+#include "cic_decimator.h"
+#include <string.h>
+
+bool cicIniciar(CicDecimator* cic, int order, int factor) {
+  if (order < 1 || order > CIC_MAX_ORDER || factor < 1 || factor > CIC_MAX_DECIMATION) return false;
+
+  cic->order = order;
+  cic->factor = factor;
+  cic->phase = 0;
+  cic->warmup = (factor > 1) ? order : 0;
+  cic->gain = 1;
+  for (int i = 0; i < order; i++) {
+    cic->gain *= (uint64_t)factor;
+  }
+  memset(cic->integrators, 0, sizeof(cic->integrators));
+  memset(cic->combs, 0, sizeof(cic->combs));
+  return true;
+}
+
+bool cicAgregar(CicDecimator* cic, int32_t sample, int32_t* out) {
+  uint64_t value = (uint64_t)(int64_t)sample;
+  for (int i = 0; i < cic->order; i++) {
+    cic->integrators[i] += value;
+    value = cic->integrators[i];
+  }
+
+  if (++cic->phase < cic->factor) return false;
+  cic->phase = 0;
+
+  for (int i = 0; i < cic->order; i++) {
+    uint64_t previous = cic->combs[i];
+    cic->combs[i] = value;
+    value -= previous;
+  }
+
+  if (cic->warmup > 0) {
+    cic->warmup--;
+    return false;
+  }
+
+  // División con redondeo al más cercano (también para valores negativos)
+  int64_t sum = (int64_t)value;
+  int64_t half = (int64_t)(cic->gain / 2);
+  int64_t gain = (int64_t)cic->gain;
+  *out = (int32_t)((sum >= 0) ? (sum + half) / gain : -((-sum + half) / gain));
+  return true;
+}
@@ -19,6 +19,9 @@ float graph_data[GRAPH_WIDTH];
 int graph_index = 0;
 float max_freq_scale = 100.0;
 
+// Variables globales - Estadística
+uint32_t quantile_window_ms = QUANTILE_WINDOW_DEFAULT_MS;
+
 // Melodías Mario Bros (éxito)
 int mario_melody[] = {
   NOTE_E7, NOTE_E7, 0, NOTE_E7, 0, NOTE_C7, NOTE_E7, 0, NOTE_G7, 0, 0, 0,
@@ -49,7 +52,8 @@ const char* TEST_CASE_NAMES[] = {
   "TC2: Normal", 
   "TC3: Compnd",
   "TC4: Strs",
-  "TC5: Single"
+  "TC5: Single",
+  "TC9: Full"
 };
 
 void updateUserActivity() {
@@ -2,6 +2,14 @@
 #include "mode_read.h"
 #include "mode_pressure.h"
 
+// Fronteras de eventos de flujo sobre el gráfico de frecuencia (0 = sin marca)
+static uint16_t graph_marks[GRAPH_WIDTH];
+static uint16_t pending_mark = 0;
+
+// Línea de texto bajo el gráfico (READ/PRESSURE)
+static char last_bottom_text[48] = "";
+static uint16_t last_bottom_color = TFT_BLACK;
+
 void playTone(int frequency, int duration_ms) {
   if (frequency > 0) {
     ledcWriteTone(0, frequency);
@@ -84,11 +92,20 @@ void dibujarLineasReferencia() {
 void actualizarGraficoGenerico(float* data, int* index, float nuevo_valor, 
                                 float min_scale, float max_scale, 
                                 uint16_t color_fill, uint16_t color_line,
-                                bool auto_scale) {
+                                bool auto_scale, const uint16_t* marks) {
   data[*index] = nuevo_valor;
   tft.fillRect(GRAPH_X, GRAPH_Y, GRAPH_WIDTH, GRAPH_HEIGHT, TFT_BLACK);
   dibujarLineasReferencia();
   
+  if (marks != nullptr) {
+    for (int i = 0; i < GRAPH_WIDTH; i++) {
+      uint16_t mark = marks[(*index + 1 + i) % GRAPH_WIDTH];
+      if (mark != 0) {
+        tft.drawFastVLine(GRAPH_X + i, GRAPH_Y, GRAPH_HEIGHT, mark);
+      }
+    }
+  }
+  
   for (int i = 1; i < GRAPH_WIDTH; i++) {
     int idx1 = (*index - GRAPH_WIDTH + i + GRAPH_WIDTH) % GRAPH_WIDTH;
     int idx2 = (*index - GRAPH_WIDTH + i + 1 + GRAPH_WIDTH) % GRAPH_WIDTH;
@@ -118,6 +135,102 @@ void actualizarGraficoGenerico(float* data, int* index, float nuevo_valor,
   *index = (*index + 1) % GRAPH_WIDTH;
 }
 
+// Vista previa del patrón: envolvente min/max de frecuencia por columna, con
+// el eje de tiempo ajustado a la duración (etiqueta bajo el gráfico)
+void dibujarVistaPrevia(const PatternPreview* preview) {
+  tft.fillRect(GRAPH_X, GRAPH_Y, GRAPH_WIDTH, GRAPH_HEIGHT, TFT_BLACK);
+  dibujarLineasReferencia();
+  
+  for (int x = 0; x < preview->width; x++) {
+    int y_top = GRAPH_Y + GRAPH_HEIGHT - (preview->freq_max[x] * GRAPH_HEIGHT / max_freq_scale);
+    int y_bottom = GRAPH_Y + GRAPH_HEIGHT - (preview->freq_min[x] * GRAPH_HEIGHT / max_freq_scale);
+    y_top = constrain(y_top, GRAPH_Y, GRAPH_Y + GRAPH_HEIGHT - 1);
+    y_bottom = constrain(y_bottom, y_top + 1, GRAPH_Y + GRAPH_HEIGHT);
+    tft.drawFastVLine(GRAPH_X + x, y_top, y_bottom - y_top, TFT_CYAN);
+  }
+  
+  char time_text[12];
+  snprintf(time_text, sizeof(time_text), "%.1fs", preview->total_ms / 1000.0);
+  tft.setTextColor(TFT_DARKGREY, TFT_BLACK);
+  tft.setTextSize(1);
+  tft.setTextFont(1);
+  tft.drawString("0", GRAPH_X, GRAPH_Y + GRAPH_HEIGHT + 4);
+  tft.setTextDatum(TR_DATUM);
+  tft.drawString(time_text, GRAPH_X + (preview->width > 0 ? preview->width : GRAPH_WIDTH), GRAPH_Y + GRAPH_HEIGHT + 4);
+  tft.setTextDatum(TL_DATUM);
+}
+
+// Captura de presión: envolvente min/max por columna con su propia escala y
+// el instante del disparo marcado en rojo
+void dibujarCapturaPresion(const PressureCaptureView* view) {
+  tft.fillRect(GRAPH_X, GRAPH_Y, GRAPH_WIDTH, GRAPH_HEIGHT, TFT_BLACK);
+  dibujarLineasReferencia();
+  if (view->trigger_x >= 0) {
+    tft.drawFastVLine(GRAPH_X + view->trigger_x, GRAPH_Y, GRAPH_HEIGHT, TFT_RED);
+  }
+  
+  float range = view->scale_max - view->scale_min;
+  for (int x = 0; x < view->width; x++) {
+    int y_top = GRAPH_Y + GRAPH_HEIGHT - ((view->value_max[x] - view->scale_min) * GRAPH_HEIGHT / range);
+    int y_bottom = GRAPH_Y + GRAPH_HEIGHT - ((view->value_min[x] - view->scale_min) * GRAPH_HEIGHT / range);
+    y_top = constrain(y_top, GRAPH_Y, GRAPH_Y + GRAPH_HEIGHT - 1);
+    y_bottom = constrain(y_bottom, y_top + 1, GRAPH_Y + GRAPH_HEIGHT);
+    tft.drawFastVLine(GRAPH_X + x, y_top, y_bottom - y_top, TFT_MAGENTA);
+  }
+}
+
+void dibujarLineaInferior(const char* text, uint16_t color) {
+  if (strcmp(text, last_bottom_text) == 0 && color == last_bottom_color) return;
+  
+  tft.fillRect(5, GRAPH_Y + GRAPH_HEIGHT + 3, 230, 10, TFT_BLACK);
+  tft.setTextColor(color);
+  tft.setTextSize(1);
+  tft.setTextFont(1);
+  tft.drawString(text, 5, GRAPH_Y + GRAPH_HEIGHT + 4);
+  strncpy(last_bottom_text, text, sizeof(last_bottom_text) - 1);
+  last_bottom_color = color;
+}
+
+// Valor corto para la pantalla: "48.9", "130", "8389k"
+static void formatearValorCorto(float value, char* text, int size) {
+  if (value >= 100000.0f) {
+    snprintf(text, size, "%.0fk", value / 1000.0f);
+  } else if (value >= 100.0f) {
+    snprintf(text, size, "%.0f", value);
+  } else {
+    snprintf(text, size, "%.1f", value);
+  }
+}
+
+static void formatearCuatroCuantiles(float p50_value, float p90_value, float p99_value, float max_value,
+                                     const char* unit, char* text, int size) {
+  char p50[10], p90[10], p99[10], max[10];
+  formatearValorCorto(p50_value, p50, sizeof(p50));
+  formatearValorCorto(p90_value, p90, sizeof(p90));
+  formatearValorCorto(p99_value, p99, sizeof(p99));
+  formatearValorCorto(max_value, max, sizeof(max));
+  snprintf(text, size, "P50 %s P90 %s P99 %s max %s%s", p50, p90, p99, max, unit);
+}
+
+void formatearCuantiles(const QuantileSummary* summary, float scale, const char* unit, char* text, int size) {
+  if (summary->count == 0) {
+    snprintf(text, size, "P50/P90/P99: sin datos");
+    return;
+  }
+  formatearCuatroCuantiles(summary->p50 * scale, summary->p90 * scale, summary->p99 * scale,
+                           summary->max * scale, unit, text, size);
+}
+
+void formatearCuantilesConvertidos(const QuantileSummary* summary, float (*convertir)(uint32_t),
+                                   const char* unit, char* text, int size) {
+  if (summary->count == 0) {
+    snprintf(text, size, "P50/P90/P99: sin datos");
+    return;
+  }
+  formatearCuatroCuantiles(convertir(summary->p50), convertir(summary->p90), convertir(summary->p99),
+                           convertir(summary->max), unit, text, size);
+}
+
 void dibujarMarcoGrafico(bool es_presion) {
   tft.drawRect(GRAPH_X - 1, GRAPH_Y - 1, GRAPH_WIDTH + 2, GRAPH_HEIGHT + 2, TFT_WHITE);
   
@@ -144,7 +257,10 @@ void dibujarMarcoGrafico(bool es_presion) {
 void inicializarGrafico() {
   for (int i = 0; i < GRAPH_WIDTH; i++) {
     graph_data[i] = 0.0;
+    graph_marks[i] = 0;
   }
+  pending_mark = 0;
+  last_bottom_text[0] = '\0';
   
   for (int i = 0; i < GRAPH_WIDTH; i++) {
     extern float pressure_graph_data[GRAPH_WIDTH];
@@ -155,7 +271,14 @@ void inicializarGrafico() {
 }
 
 void actualizarGrafico(float nueva_frecuencia) {
+  graph_marks[graph_index] = pending_mark;
+  pending_mark = 0;
   actualizarGraficoGenerico(graph_data, &graph_index, nueva_frecuencia,
                             0.0, max_freq_scale,
-                            TFT_BLUE, TFT_CYAN, false);
+                            TFT_BLUE, TFT_CYAN, false, graph_marks);
+}
+
+// La marca se dibuja en la próxima columna del gráfico de frecuencia
+void marcarGrafico(uint16_t color) {
+  pending_mark = color;
 }
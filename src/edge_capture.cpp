@@ -0,0 +1,164 @@
+#include "edge_capture.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "driver/mcpwm.h"
+#else
+#define IRAM_ATTR
+#endif
+
+#define EDGE_CAPTURE_WRAP_TICKS (1ULL << 32)
+
+volatile EdgeCaptureStats edge_capture_stats;
+
+static bool capture_active = false;
+static EdgeTimestampRing* timestamp_ring = nullptr;
+static TimestampRing<EDGE_CAPTURE_RING_SIZE> period_ring;
+static TimestampRing<EDGE_CAPTURE_RING_SIZE> width_ring;
+
+// Estado de la ISR: contador extendido y su equivalente en la base de micros()
+static bool have_edge = false;
+static uint32_t first_ticks = 0;
+static uint32_t last_ticks = 0;
+static uint32_t last_edge_us = 0;      // micros() del último flanco (para las vueltas)
+static uint64_t edge_ticks = 0;        // Ticks extendidos del último flanco
+static uint32_t edge_us = 0;           // Mismo instante en µs, base de micros()
+static uint32_t edge_frac_ticks = 0;   // Resto de la conversión a µs
+static bool have_rise = false;
+static uint64_t rise_ticks = 0;
+
+static inline uint32_t saturar32(uint64_t ticks) {
+  return (ticks > UINT32_MAX) ? UINT32_MAX : (uint32_t)ticks;
+}
+
+static void IRAM_ATTR registrarFlanco(uint32_t ticks, bool rising, uint32_t now_us) {
+  if (!have_edge) {
+    // Primer flanco: fija la correspondencia ticks <-> micros()
+    have_edge = true;
+    first_ticks = ticks;
+    edge_ticks = 0;
+    edge_us = now_us;
+    edge_frac_ticks = 0;
+  } else {
+    uint32_t delta = ticks - last_ticks;
+    uint32_t elapsed_us = now_us - last_edge_us;
+    uint32_t advance_us;
+    // Hueco de más de media vuelta: micros() dice cuántas vueltas completas faltan
+    if (elapsed_us > (uint32_t)(EDGE_CAPTURE_WRAP_TICKS / 2 / EDGE_CAPTURE_TICKS_PER_US)) {
+      int64_t missing = (int64_t)elapsed_us * EDGE_CAPTURE_TICKS_PER_US - delta;
+      uint32_t wraps = (uint32_t)((missing + (int64_t)(EDGE_CAPTURE_WRAP_TICKS / 2)) >> 32);
+      uint64_t full = delta + ((uint64_t)wraps << 32);
+      edge_ticks += full;
+      advance_us = (uint32_t)(full / EDGE_CAPTURE_TICKS_PER_US);
+      edge_frac_ticks += (uint32_t)(full % EDGE_CAPTURE_TICKS_PER_US);
+    } else {
+      edge_ticks += delta;
+      advance_us = delta / EDGE_CAPTURE_TICKS_PER_US;
+      edge_frac_ticks += delta % EDGE_CAPTURE_TICKS_PER_US;
+    }
+    if (edge_frac_ticks >= EDGE_CAPTURE_TICKS_PER_US) {
+      edge_frac_ticks -= EDGE_CAPTURE_TICKS_PER_US;
+      advance_us++;
+    }
+    edge_us += advance_us;
+    edge_capture_stats.wraps = (uint32_t)((edge_ticks + first_ticks) >> 32);
+  }
+  last_ticks = ticks;
+  last_edge_us = now_us;
+
+  if (rising) {
+    edge_capture_stats.rising++;
+    if (have_rise) {
+      timestampRingInsertar(&period_ring, saturar32(edge_ticks - rise_ticks));
+    }
+    have_rise = true;
+    rise_ticks = edge_ticks;
+    if (timestamp_ring) timestampRingInsertar(timestamp_ring, edge_us);
+  } else {
+    edge_capture_stats.falling++;
+    // Bajada antes de la primera subida: el pulso empezó antes de capturar
+    if (have_rise) {
+      timestampRingInsertar(&width_ring, saturar32(edge_ticks - rise_ticks));
+    }
+  }
+}
+
+// --- HAL: unidad de captura MCPWM (ESP32) o flancos inyectados (host) ---
+
+#ifdef ARDUINO
+
+#define EDGE_CAPTURE_MCPWM_UNIT ((mcpwm_unit_t)EDGE_CAPTURE_UNIT)
+
+static bool IRAM_ATTR capturaIsr(mcpwm_unit_t unit, mcpwm_capture_channel_id_t channel,
+                                 const cap_event_data_t* edata, void* user_data) {
+  registrarFlanco(edata->cap_value, edata->cap_edge == MCPWM_POS_EDGE, micros());
+  return false;  // Sin tareas que despertar
+}
+
+static bool halIniciar(uint8_t pin) {
+  if (mcpwm_gpio_init(EDGE_CAPTURE_MCPWM_UNIT, MCPWM_CAP_0, pin) != ESP_OK) return false;
+
+  mcpwm_capture_config_t config = {};
+  config.cap_edge = MCPWM_BOTH_EDGE;
+  config.cap_prescale = 1;
+  config.capture_cb = capturaIsr;
+  config.user_data = nullptr;
+  return mcpwm_capture_enable_channel(EDGE_CAPTURE_MCPWM_UNIT, MCPWM_SELECT_CAP0, &config) == ESP_OK;
+}
+
+static void halDetener() {
+  mcpwm_capture_disable_channel(EDGE_CAPTURE_MCPWM_UNIT, MCPWM_SELECT_CAP0);
+}
+
+#else
+
+static bool halIniciar(uint8_t pin) {
+  return true;
+}
+
+static void halDetener() {
+}
+
+void edgeCaptureHostFlanco(uint32_t ticks, bool rising, uint32_t now_us) {
+  if (capture_active) registrarFlanco(ticks, rising, now_us);
+}
+
+#endif
+
+bool edgeCaptureIniciar(uint8_t pin, EdgeTimestampRing* timestamps) {
+  edgeCaptureDetener();
+
+  timestamp_ring = timestamps;
+  timestampRingVaciar(&period_ring);
+  timestampRingVaciar(&width_ring);
+  edge_capture_stats.rising = 0;
+  edge_capture_stats.falling = 0;
+  edge_capture_stats.wraps = 0;
+  have_edge = false;
+  have_rise = false;
+
+  capture_active = halIniciar(pin);
+  return capture_active;
+}
+
+void edgeCaptureDetener() {
+  if (!capture_active) return;
+  halDetener();
+  capture_active = false;
+}
+
+bool edgeCaptureActivo() {
+  return capture_active;
+}
+
+bool edgeCaptureLeerPeriodo(uint32_t* ticks) {
+  return timestampRingLeer(&period_ring, ticks);
+}
+
+bool edgeCaptureLeerAncho(uint32_t* ticks) {
+  return timestampRingLeer(&width_ring, ticks);
+}
+
+uint32_t edgeCaptureDesbordes() {
+  return period_ring.overflows + width_ring.overflows;
+}
@@ -0,0 +1,199 @@
+#include "flow_segmenter.h"
+
+static void abrirEvento(FlowSegmenter* seg, FlowEventType type, uint32_t start_us) {
+  seg->current.type = type;
+  seg->current.flow = seg->flow_count;
+  seg->current.pulses = 0;
+  seg->current.periods = 0;
+  seg->current.period_sum_us = 0;
+  seg->current.start_us = start_us;
+  seg->current.end_us = start_us;
+  seg->current.timeout = false;
+  seg->first_period_us = 0;
+  seg->last_period_us = 0;
+  seg->fastest_period_us = 0;
+}
+
+static void sumarPeriodo(FlowSegmenter* seg, uint32_t period_us, uint32_t t_us) {
+  if (seg->current.periods == 0) seg->first_period_us = period_us;
+  seg->last_period_us = period_us;
+  seg->current.pulses++;
+  seg->current.periods++;
+  seg->current.period_sum_us += period_us;
+  seg->current.end_us = t_us;
+  if (seg->current.type == FLOW_EVENT_STARTUP &&
+      (seg->fastest_period_us == 0 || period_us < seg->fastest_period_us)) {
+    seg->fastest_period_us = period_us;
+    seg->fastest = seg->current;
+  }
+}
+
+static void iniciarRacha(FlowSegmenter* seg, uint32_t period_us, uint32_t t_us) {
+  seg->run_periods = 1;
+  seg->run_sum_us = period_us;
+  seg->run_start_us = t_us - period_us;
+  seg->run_first_period_us = period_us;
+}
+
+// |a - ref| > ref * percent / 100
+static bool fueraDeMargen(uint32_t period_us, uint32_t ref_us, int percent) {
+  uint32_t diff = (period_us > ref_us) ? period_us - ref_us : ref_us - period_us;
+  return (uint64_t)diff * 100 > (uint64_t)ref_us * percent;
+}
+
+void segmentadorIniciar(FlowSegmenter* seg, uint32_t timeout_ms) {
+  seg->timeout_us = timeout_ms * 1000;
+  seg->in_flow = false;
+  seg->skip_period = false;
+  seg->stop_pending = false;
+  seg->flow_count = 0;
+  seg->flow_pulses = 0;
+  seg->last_edge_us = 0;
+  seg->run_periods = 0;
+  seg->stable_ref_us = 0;
+  abrirEvento(seg, FLOW_EVENT_STARTUP, 0);
+}
+
+void segmentadorDiscontinuidad(FlowSegmenter* seg) {
+  seg->skip_period = true;
+}
+
+bool segmentadorPulso(FlowSegmenter* seg, uint32_t t_us, FlowEvent* closed) {
+  if (!seg->in_flow) {
+    // Primer pulso tras IDLE: nuevo flujo
+    seg->in_flow = true;
+    seg->skip_period = false;
+    seg->flow_count++;
+    seg->flow_pulses = 1;
+    seg->last_edge_us = t_us;
+    seg->run_periods = 0;
+    seg->flow_ref_us = 0;
+    seg->flow_ref_pulses = 0;
+    seg->stop_pending = false;
+    abrirEvento(seg, FLOW_EVENT_STARTUP, t_us);
+    seg->current.pulses = 1;
+    return false;
+  }
+
+  uint32_t period_us = t_us - seg->last_edge_us;
+  seg->last_edge_us = t_us;
+  seg->flow_pulses++;
+
+  if (seg->skip_period) {
+    // Pulso contado, pero su período no entra en medias ni rachas
+    seg->skip_period = false;
+    seg->current.pulses++;
+    seg->current.end_us = t_us;
+    seg->run_periods = 0;
+    return false;
+  }
+
+  if (seg->current.type == FLOW_EVENT_STABLE) {
+    if (!fueraDeMargen(period_us, seg->stable_ref_us, SEGMENT_ABRUPT_PERCENT)) {
+      sumarPeriodo(seg, period_us, t_us);
+      seg->stable_ref_us = (uint32_t)(seg->current.period_sum_us / seg->current.periods);
+      return false;
+    }
+    // Cambio abrupto: el pulso abre una TRANSITION
+    *closed = seg->current;
+    if (closed->pulses > seg->flow_ref_pulses) {
+      seg->flow_ref_pulses = closed->pulses;
+      seg->flow_ref_us = seg->stable_ref_us;
+    }
+    abrirEvento(seg, FLOW_EVENT_TRANSITION, t_us - period_us);
+    sumarPeriodo(seg, period_us, t_us);
+    iniciarRacha(seg, period_us, t_us);
+    return true;
+  }
+
+  // STARTUP / TRANSITION: buscar una racha estable
+  sumarPeriodo(seg, period_us, t_us);
+  if (seg->run_periods > 0 &&
+      !fueraDeMargen(period_us, (uint32_t)(seg->run_sum_us / seg->run_periods), SEGMENT_STABLE_PERCENT)) {
+    seg->run_periods++;
+    seg->run_sum_us += period_us;
+  } else {
+    iniciarRacha(seg, period_us, t_us);
+  }
+  if (seg->run_periods < SEGMENT_STABLE_PULSES) return false;
+
+  // Estable: la frontera va al inicio de la racha. Si no queda nada antes
+  // (STARTUP solo con el primer pulso) el evento entero pasa a STABLE
+  uint32_t before = seg->current.pulses - seg->run_periods;
+  bool emit = (seg->current.type == FLOW_EVENT_STARTUP) ? before > 1 : before > 0;
+  if (emit) {
+    *closed = seg->current;
+    closed->pulses = before;
+    closed->periods -= seg->run_periods;
+    closed->period_sum_us -= seg->run_sum_us;
+    closed->end_us = seg->run_start_us;
+  }
+  uint32_t pulses = emit ? seg->run_periods : seg->current.pulses;
+  abrirEvento(seg, FLOW_EVENT_STABLE, emit ? seg->run_start_us : seg->current.start_us);
+  seg->current.pulses = pulses;
+  seg->current.periods = seg->run_periods;
+  seg->current.period_sum_us = seg->run_sum_us;
+  seg->current.end_us = t_us;
+  seg->first_period_us = seg->run_first_period_us;
+  seg->last_period_us = period_us;
+  seg->stable_ref_us = (uint32_t)(seg->run_sum_us / seg->run_periods);
+  seg->run_periods = 0;
+  return emit;
+}
+
+bool segmentadorTick(FlowSegmenter* seg, uint32_t now_us, FlowEvent* closed) {
+  if (!seg->in_flow || now_us - seg->last_edge_us < seg->timeout_us) return false;
+
+  *closed = seg->current;
+  closed->timeout = true;
+  if (seg->stop_pending) {
+    // Cola frenada del STARTUP partido en la llamada anterior
+    seg->stop_pending = false;
+    closed->type = FLOW_EVENT_STOP;
+  } else if (seg->flow_pulses <= SEGMENT_LEAK_MAX_PULSES) {
+    closed->type = FLOW_EVENT_LEAK;
+  } else if (seg->flow_ref_pulses > 0) {
+    // Parada gradual: el final va más lento que el régimen principal del flujo
+    bool main_stable = closed->type == FLOW_EVENT_STABLE && closed->pulses > seg->flow_ref_pulses;
+    if (!main_stable && closed->periods > 0 &&
+        closed->period_sum_us * 100 > (uint64_t)seg->flow_ref_us * closed->periods * (100 + SEGMENT_ABRUPT_PERCENT)) {
+      closed->type = FLOW_EVENT_STOP;
+    }
+  } else if (closed->type == FLOW_EVENT_TRANSITION && seg->last_period_us > seg->first_period_us) {
+    closed->type = FLOW_EVENT_STOP;  // Sin régimen estable: transición que se frena
+  } else if (closed->type == FLOW_EVENT_STARTUP && seg->fastest.periods < closed->periods &&
+             seg->last_period_us > seg->fastest_period_us &&
+             fueraDeMargen(seg->last_period_us, seg->fastest_period_us, SEGMENT_STABLE_PERCENT)) {
+    // Arranque que acelera y frena sin estabilizarse: STARTUP hasta el
+    // período más rápido; el resto queda como STOP para la siguiente llamada
+    *closed = seg->fastest;
+    closed->timeout = true;
+    seg->current.pulses -= seg->fastest.pulses;
+    seg->current.periods -= seg->fastest.periods;
+    seg->current.period_sum_us -= seg->fastest.period_sum_us;
+    seg->current.start_us = seg->fastest.end_us;
+    seg->stop_pending = true;
+    return true;
+  }
+  seg->in_flow = false;
+  return true;
+}
+
+const char* segmentadorNombreTipo(FlowEventType type) {
+  switch (type) {
+    case FLOW_EVENT_STARTUP: return "STARTUP";
+    case FLOW_EVENT_STABLE: return "STABLE";
+    case FLOW_EVENT_TRANSITION: return "TRANSITION";
+    case FLOW_EVENT_STOP: return "STOP";
+    case FLOW_EVENT_LEAK: return "LEAK";
+  }
+  return "?";
+}
+
+uint32_t segmentadorDuracionMs(const FlowEvent* event) {
+  return (event->end_us - event->start_us) / 1000;
+}
+
+float segmentadorPeriodoMedioMs(const FlowEvent* event) {
+  return (event->periods > 0) ? (float)(event->period_sum_us / 1000.0 / event->periods) : 0.0f;
+}
@@ -0,0 +1,313 @@
+#include "flow_totalizer.h"
+#include "pattern_file.h"  // patternFileCrc32
+#include <stddef.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <Preferences.h>
+#include "esp_attr.h"
+#endif
+
+#define TOTALIZER_MAGIC 0x544F5431UL      // "TOT1"
+#define TOTALIZER_CFG_MAGIC 0x4B464331UL  // "KFC1"
+#define TOTALIZER_WRITE_INTERVAL_MS (3600000UL / TOTALIZER_MAX_WRITES_PER_HOUR)
+
+struct TotalizerRecord {
+  uint32_t magic;
+  uint32_t seq;
+  uint64_t pulses;
+  uint64_t volume_ul;
+  uint32_t crc;          // De todo lo anterior
+};
+
+struct TotalizerConfigRecord {
+  uint32_t magic;
+  TotalizerConfig config;
+  uint32_t crc;
+};
+
+TotalizerTotals totalizer_totals;
+TotalizerConfig totalizer_config;
+TotalizerStats totalizer_stats;
+
+static uint64_t volume_remainder = 0;  // Fracción de µL pendiente (en µL * 2^16)
+
+template <typename T>
+static uint32_t crcRegistro(const T& record) {
+  return patternFileCrc32(0, (const uint8_t*)&record, offsetof(T, crc));
+}
+
+static bool registroValido(const TotalizerRecord& record) {
+  return record.magic == TOTALIZER_MAGIC && record.crc == crcRegistro(record);
+}
+
+// --- HAL: RTC + Preferences (ESP32) o memoria simulada (host) ---
+
+#ifdef ARDUINO
+
+// Sin inicializar en ningún arranque: sobrevive a deep sleep y reinicios por software
+RTC_NOINIT_ATTR static TotalizerRecord rtc_record;
+static Preferences prefs;
+static bool prefs_ready = false;
+
+static void claveSlot(int slot, char* key) {
+  snprintf(key, 8, "tot%d", slot);
+}
+
+static bool halIniciar() {
+  prefs_ready = prefs.begin(TOTALIZER_NVS_NAMESPACE, false);
+  return prefs_ready;
+}
+
+static bool halLeerSlot(int slot, TotalizerRecord* record) {
+  char key[8];
+  claveSlot(slot, key);
+  return prefs_ready && prefs.getBytes(key, record, sizeof(*record)) == sizeof(*record);
+}
+
+static bool halEscribirSlot(int slot, const TotalizerRecord& record) {
+  char key[8];
+  claveSlot(slot, key);
+  return prefs_ready && prefs.putBytes(key, &record, sizeof(record)) == sizeof(record);
+}
+
+static bool halLeerConfig(TotalizerConfigRecord* record) {
+  return prefs_ready && prefs.getBytes("cfg", record, sizeof(*record)) == sizeof(*record);
+}
+
+static bool halEscribirConfig(const TotalizerConfigRecord& record) {
+  return prefs_ready && prefs.putBytes("cfg", &record, sizeof(record)) == sizeof(record);
+}
+
+#else
+
+static TotalizerRecord rtc_record;
+static TotalizerRecord host_slots[TOTALIZER_SLOTS];
+static bool host_slot_written[TOTALIZER_SLOTS];
+static TotalizerConfigRecord host_config;
+static bool host_config_written = false;
+
+static bool halIniciar() {
+  return true;
+}
+
+static bool halLeerSlot(int slot, TotalizerRecord* record) {
+  if (!host_slot_written[slot]) return false;
+  *record = host_slots[slot];
+  return true;
+}
+
+static bool halEscribirSlot(int slot, const TotalizerRecord& record) {
+  host_slots[slot] = record;
+  host_slot_written[slot] = true;
+  return true;
+}
+
+static bool halLeerConfig(TotalizerConfigRecord* record) {
+  if (!host_config_written) return false;
+  *record = host_config;
+  return true;
+}
+
+static bool halEscribirConfig(const TotalizerConfigRecord& record) {
+  host_config = record;
+  host_config_written = true;
+  return true;
+}
+
+void totalizadorHostReinicio(bool power_loss) {
+  if (power_loss) {
+    memset(&rtc_record, 0xA5, sizeof(rtc_record));  // Contenido indeterminado
+  }
+  memset(&totalizer_totals, 0, sizeof(totalizer_totals));
+  memset(&totalizer_stats, 0, sizeof(totalizer_stats));
+  volume_remainder = 0;
+}
+
+void totalizadorHostCorromperSlot(int slot) {
+  host_slots[slot].volume_ul ^= 0x1234;  // Escritura a medias: el CRC ya no cuadra
+}
+
+#endif
+
+// --- Totales ---
+
+static void actualizarRtc() {
+  rtc_record.magic = TOTALIZER_MAGIC;
+  rtc_record.seq = totalizer_totals.seq;
+  rtc_record.pulses = totalizer_totals.pulses;
+  rtc_record.volume_ul = totalizer_totals.volume_ul;
+  rtc_record.crc = crcRegistro(rtc_record);
+}
+
+static void configPorDefecto() {
+  totalizer_config.k_factor = TOTALIZER_K_FACTOR_DEFAULT;
+  totalizer_config.point_count = 0;
+}
+
+static bool guardarConfig() {
+  TotalizerConfigRecord record;
+  memset(&record, 0, sizeof(record));
+  record.magic = TOTALIZER_CFG_MAGIC;
+  record.config = totalizer_config;
+  record.crc = crcRegistro(record);
+  return halEscribirConfig(record);
+}
+
+TotalizerSource totalizadorIniciar(uint32_t now_ms) {
+  halIniciar();
+
+  TotalizerConfigRecord cfg;
+  if (halLeerConfig(&cfg) && cfg.magic == TOTALIZER_CFG_MAGIC && cfg.crc == crcRegistro(cfg) &&
+      cfg.config.k_factor > 0.0f && cfg.config.point_count >= 0 && cfg.config.point_count <= TOTALIZER_MAX_POINTS) {
+    totalizer_config = cfg.config;
+  } else {
+    configPorDefecto();
+  }
+
+  // Registro NVS válido más reciente
+  TotalizerRecord nvs_best;
+  bool have_nvs = false;
+  for (int slot = 0; slot < TOTALIZER_SLOTS; slot++) {
+    TotalizerRecord record;
+    if (halLeerSlot(slot, &record) && registroValido(record) && (!have_nvs || record.seq > nvs_best.seq)) {
+      nvs_best = record;
+      have_nvs = true;
+    }
+  }
+
+  TotalizerRecord best;
+  memset(&best, 0, sizeof(best));  // Sin datos: totales a cero
+  totalizer_stats.source = TOTALIZER_FROM_NONE;
+  if (registroValido(rtc_record) && (!have_nvs || rtc_record.seq >= nvs_best.seq)) {
+    best = rtc_record;
+    totalizer_stats.source = TOTALIZER_FROM_RTC;
+  } else if (have_nvs) {
+    best = nvs_best;
+    totalizer_stats.source = TOTALIZER_FROM_NVS;
+  }
+
+  totalizer_totals.pulses = best.pulses;
+  totalizer_totals.volume_ul = best.volume_ul;
+  totalizer_totals.seq = best.seq;
+  volume_remainder = 0;
+  // Lo recuperado de RTC puede no estar aún en NVS
+  totalizer_stats.dirty = (totalizer_stats.source == TOTALIZER_FROM_RTC) &&
+                          !(have_nvs && nvs_best.pulses == best.pulses && nvs_best.volume_ul == best.volume_ul);
+  totalizer_stats.writes = 0;
+  totalizer_stats.write_errors = 0;
+  // La primera escritura espera un intervalo completo: un bucle de reinicios no desgasta la flash
+  totalizer_stats.last_write_ms = now_ms;
+  actualizarRtc();
+  return totalizer_stats.source;
+}
+
+float totalizadorFactorCorreccion(float freq_hz) {
+  const TotalizerConfig* config = &totalizer_config;
+  int n = config->point_count;
+  if (n == 0) return 1.0f;
+  if (freq_hz <= config->point_hz[0]) return config->point_factor[0];
+  if (freq_hz >= config->point_hz[n - 1]) return config->point_factor[n - 1];
+
+  int i = 1;
+  while (config->point_hz[i] < freq_hz) i++;
+  float span = config->point_hz[i] - config->point_hz[i - 1];
+  float t = (freq_hz - config->point_hz[i - 1]) / span;
+  return config->point_factor[i - 1] + (config->point_factor[i] - config->point_factor[i - 1]) * t;
+}
+
+void totalizadorSumar(uint32_t pulses, float freq_hz) {
+  if (pulses == 0) return;
+
+  // µL en punto fijo 16.16 para no perder la fracción entre llamadas
+  double ul_per_pulse = 1000000.0 * totalizadorFactorCorreccion(freq_hz) / totalizer_config.k_factor;
+  volume_remainder += (uint64_t)(ul_per_pulse * 65536.0 + 0.5) * pulses;
+  totalizer_totals.volume_ul += volume_remainder >> 16;
+  volume_remainder &= 0xFFFF;
+  totalizer_totals.pulses += pulses;
+  totalizer_stats.dirty = true;
+  actualizarRtc();
+}
+
+uint32_t totalizadorEsperaEscrituraMs(uint32_t now_ms) {
+  uint32_t elapsed_ms = now_ms - totalizer_stats.last_write_ms;
+  return (elapsed_ms >= TOTALIZER_WRITE_INTERVAL_MS) ? 0 : TOTALIZER_WRITE_INTERVAL_MS - elapsed_ms;
+}
+
+void totalizadorServicio(uint32_t now_ms) {
+  if (!totalizer_stats.dirty || totalizadorEsperaEscrituraMs(now_ms) > 0) return;
+
+  TotalizerRecord record;
+  memset(&record, 0, sizeof(record));
+  record.magic = TOTALIZER_MAGIC;
+  record.seq = totalizer_totals.seq + 1;
+  record.pulses = totalizer_totals.pulses;
+  record.volume_ul = totalizer_totals.volume_ul;
+  record.crc = crcRegistro(record);
+
+  // Siempre a la clave siguiente: la anterior queda como respaldo
+  totalizer_stats.last_write_ms = now_ms;
+  if (!halEscribirSlot((int)(record.seq % TOTALIZER_SLOTS), record)) {
+    totalizer_stats.write_errors++;
+    return;
+  }
+  totalizer_totals.seq = record.seq;
+  totalizer_stats.writes++;
+  totalizer_stats.dirty = false;
+  actualizarRtc();
+}
+
+void totalizadorPuestaACero() {
+  totalizer_totals.pulses = 0;
+  totalizer_totals.volume_ul = 0;
+  volume_remainder = 0;
+  totalizer_stats.dirty = true;
+  actualizarRtc();
+}
+
+float totalizadorLitros() {
+  return (float)((double)totalizer_totals.volume_ul / 1000000.0);
+}
+
+bool totalizadorConfigurarK(float k_factor) {
+  if (!(k_factor > 0.0f)) return false;
+  totalizer_config.k_factor = k_factor;
+  return guardarConfig();
+}
+
+bool totalizadorPuntoCorreccion(float freq_hz, float factor) {
+  TotalizerConfig* config = &totalizer_config;
+  if (!(freq_hz > 0.0f) || !(factor > 0.0f)) return false;
+
+  // Misma frecuencia: se sustituye; si no, inserción ordenada
+  int i = 0;
+  while (i < config->point_count && config->point_hz[i] < freq_hz) i++;
+  if (i < config->point_count && config->point_hz[i] == freq_hz) {
+    config->point_factor[i] = factor;
+  } else {
+    if (config->point_count >= TOTALIZER_MAX_POINTS) return false;
+    for (int j = config->point_count; j > i; j--) {
+      config->point_hz[j] = config->point_hz[j - 1];
+      config->point_factor[j] = config->point_factor[j - 1];
+    }
+    config->point_hz[i] = freq_hz;
+    config->point_factor[i] = factor;
+    config->point_count++;
+  }
+  return guardarConfig();
+}
+
+void totalizadorBorrarCorreccion() {
+  totalizer_config.point_count = 0;
+  guardarConfig();
+}
+
+const char* totalizadorNombreOrigen(TotalizerSource source) {
+  switch (source) {
+    case TOTALIZER_FROM_NONE: return "sin datos";
+    case TOTALIZER_FROM_RTC: return "RTC";
+    case TOTALIZER_FROM_NVS: return "NVS";
+  }
+  return "?";
+}
@@ -0,0 +1,98 @@
+#include "frequency_estimator.h"
+
+void frecuenciaIniciar(FrequencyEstimator* est, bool timestamps, uint32_t timeout_ms) {
+  est->timestamps = timestamps;
+  est->have_reference = false;
+  est->reference_us = 0;
+  est->last_edge_us = 0;
+  est->edges = 0;
+  est->method = FREQ_METHOD_STOPPED;
+  est->frequency_hz = 0.0;
+  frecuenciaTimeout(est, timeout_ms);
+}
+
+void frecuenciaTimeout(FrequencyEstimator* est, uint32_t timeout_ms) {
+  est->timeout_us = timeout_ms * 1000;
+}
+
+void frecuenciaFlanco(FrequencyEstimator* est, uint32_t t_us) {
+  if (!est->have_reference) {
+    est->reference_us = t_us;
+    est->have_reference = true;
+  } else {
+    est->edges++;
+  }
+  est->last_edge_us = t_us;
+}
+
+void frecuenciaDiscontinuidad(FrequencyEstimator* est) {
+  // El intervalo entre reference y el siguiente flanco ya no es real
+  est->have_reference = false;
+  est->edges = 0;
+}
+
+float frecuenciaActualizar(FrequencyEstimator* est, uint32_t now_us, uint32_t gate_pulses, uint32_t gate_us) {
+  float gated_hz = (gate_us > 0) ? (float)(gate_pulses * 1000000.0 / gate_us) : 0.0;
+
+  if (!est->timestamps) {
+    est->method = (gate_pulses > 0) ? FREQ_METHOD_GATED : FREQ_METHOD_STOPPED;
+    est->frequency_hz = gated_hz;
+    return est->frequency_hz;
+  }
+
+  // Cambio de método con histéresis para no oscilar en el umbral
+  if (est->method == FREQ_METHOD_GATED) {
+    if (gated_hz < READ_GATED_ABOVE_HZ * 0.8f) est->method = FREQ_METHOD_RECIPROCAL;
+  } else if (gated_hz > READ_GATED_ABOVE_HZ) {
+    est->method = FREQ_METHOD_GATED;
+  }
+
+  if (est->method == FREQ_METHOD_GATED) {
+    est->frequency_hz = gated_hz;
+    // La referencia avanza igual: volver a recíproco no mezcla ventanas
+    if (est->edges > 0) {
+      est->reference_us = est->last_edge_us;
+      est->edges = 0;
+    }
+    return est->frequency_hz;
+  }
+
+  if (est->edges > 0) {
+    uint32_t span_us = est->last_edge_us - est->reference_us;
+    if (span_us > 0) {
+      est->frequency_hz = (float)(est->edges * 1000000.0 / span_us);
+      est->method = FREQ_METHOD_RECIPROCAL;
+    }
+    est->reference_us = est->last_edge_us;
+    est->edges = 0;
+    return est->frequency_hz;
+  }
+
+  // Sin flancos nuevos
+  if (!est->have_reference) {
+    est->method = FREQ_METHOD_STOPPED;
+    est->frequency_hz = 0.0;
+    return est->frequency_hz;
+  }
+
+  uint32_t since_us = now_us - est->reference_us;
+  if (since_us >= est->timeout_us) {
+    // Flujo parado: el siguiente pulso solo sirve de referencia
+    est->have_reference = false;
+    est->method = FREQ_METHOD_STOPPED;
+    est->frequency_hz = 0.0;
+  } else if (est->frequency_hz > 0.0f && since_us > 0 && since_us * est->frequency_hz > 1000000.0f) {
+    // Ya pasó más de un período: la frecuencia no puede ser mayor que 1 / since
+    est->frequency_hz = (float)(1000000.0 / since_us);
+  }
+  return est->frequency_hz;
+}
+
+const char* frecuenciaNombreMetodo(FrequencyMethod method) {
+  switch (method) {
+    case FREQ_METHOD_STOPPED: return "parado";
+    case FREQ_METHOD_RECIPROCAL: return "recíproco";
+    case FREQ_METHOD_GATED: return "ventana";
+  }
+  return "?";
+}
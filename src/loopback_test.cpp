@@ -0,0 +1,183 @@
+#include "loopback_test.h"
+#include "pulse_capture.h"
+#include "pulse_telemetry.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// Límites superiores (exclusivos) de las cubetas de latencia; la última es abierta
+const uint32_t LOOPBACK_HIST_LIMITS_US[LOOPBACK_HIST_BINS - 1] = {
+  2, 5, 10, 20, 50, 100
+};
+
+static LoopbackSummary loopback_summary;
+
+// Estado del emparejado
+static uint32_t next_seq = 1;
+static bool have_generated = false;
+static uint32_t generated_seq = 0;
+static uint32_t generated_us = 0;
+static uint32_t generated_planned_us = 0;
+static bool have_captured = false;
+static uint32_t captured_us = 0;
+static uint32_t last_matched_seq = 0;
+static uint32_t last_matched_us = 0;
+
+void loopbackReset() {
+  memset(&loopback_summary, 0, sizeof(loopback_summary));
+  loopback_summary.min_latency_us = UINT32_MAX;
+  next_seq = 1;
+  have_generated = false;
+  have_captured = false;
+  last_matched_seq = 0;
+}
+
+static void registrarPareja() {
+  uint32_t latency_us = captured_us - generated_us;
+  LoopbackSummary* s = &loopback_summary;
+
+  s->matched++;
+  s->sum_latency_us += latency_us;
+  s->sum_sq_latency_us += (uint64_t)latency_us * latency_us;
+  if (latency_us < s->min_latency_us) s->min_latency_us = latency_us;
+  if (latency_us > s->max_latency_us) s->max_latency_us = latency_us;
+
+  int bin = 0;
+  while (bin < LOOPBACK_HIST_BINS - 1 && latency_us >= LOOPBACK_HIST_LIMITS_US[bin]) {
+    bin++;
+  }
+  s->histogram[bin]++;
+
+  // Período capturado frente al planificado (solo entre pulsos consecutivos)
+  if (last_matched_seq != 0 && generated_seq == last_matched_seq + 1) {
+    int32_t error_us = (int32_t)((captured_us - last_matched_us) - generated_planned_us);
+    uint32_t abs_error_us = (error_us < 0) ? (uint32_t)(-error_us) : (uint32_t)error_us;
+    s->period_count++;
+    s->sum_period_error_us += error_us;
+    if (abs_error_us > s->max_abs_period_error_us) s->max_abs_period_error_us = abs_error_us;
+  }
+  last_matched_seq = generated_seq;
+  last_matched_us = captured_us;
+}
+
+void loopbackProcesar(uint32_t now_us) {
+  LoopbackSummary* s = &loopback_summary;
+
+  while (true) {
+    if (!have_generated && next_seq <= pulseTelemetryUltimoSeq()) {
+      PulseTelemetryRecord rec;
+      if (pulseTelemetryLeer(next_seq, &rec)) {
+        have_generated = true;
+        generated_seq = rec.seq;
+        generated_us = rec.rise_us;
+        generated_planned_us = rec.planned_us;
+        s->generated++;
+      } else {
+        s->lost_records++;
+      }
+      next_seq++;
+      continue;
+    }
+
+    if (!have_captured && pulseCaptureLeer(&captured_us)) {
+      have_captured = true;
+      s->captured++;
+    }
+
+    if (have_generated && have_captured) {
+      int32_t delta_us = (int32_t)(captured_us - generated_us);
+      if (delta_us < 0) {
+        s->extra++;           // Flanco capturado antes del pulso generado
+        have_captured = false;
+      } else if (delta_us <= LOOPBACK_MATCH_WINDOW_US) {
+        registrarPareja();
+        have_generated = false;
+        have_captured = false;
+      } else {
+        s->missed++;          // La captura pertenece a un pulso posterior
+        have_generated = false;
+      }
+      continue;
+    }
+
+    // Sin pareja posible: decidir cuando ha pasado la ventana
+    if (have_generated && (int32_t)(now_us - generated_us) > LOOPBACK_MATCH_WINDOW_US) {
+      s->missed++;
+      have_generated = false;
+      continue;
+    }
+    if (have_captured && (int32_t)(now_us - captured_us) > LOOPBACK_MATCH_WINDOW_US) {
+      s->extra++;
+      have_captured = false;
+      continue;
+    }
+    break;
+  }
+}
+
+void loopbackFinalizar(uint32_t now_us) {
+  loopbackProcesar(now_us + LOOPBACK_MATCH_WINDOW_US + 1);
+}
+
+void loopbackObtenerResumen(LoopbackSummary* out) {
+  *out = loopback_summary;
+}
+
+#ifdef ARDUINO
+static bool loopback_active = false;
+
+void loopbackActivar(bool active) {
+  if (active) {
+    loopbackReset();
+    pulseCaptureIniciar(LOOPBACK_CAPTURE_PIN);
+  } else {
+    pulseCaptureDetener();
+  }
+  loopback_active = active;
+}
+
+bool loopbackActivo() {
+  return loopback_active;
+}
+
+void loopbackImprimirInforme() {
+  LoopbackSummary s;
+  loopbackObtenerResumen(&s);
+
+  Serial.println("=== AUTOTEST LAZO CERRADO ===");
+  Serial.printf("Generados: %lu | Capturados: %lu | Emparejados: %lu | Perdidos: %lu | Extra: %lu\n",
+                (unsigned long)s.generated, (unsigned long)s.captured, (unsigned long)s.matched,
+                (unsigned long)s.missed, (unsigned long)s.extra);
+  if (s.lost_records > 0 || pulse_capture_overflows > 0) {
+    Serial.printf("AVISO: %lu registros de telemetría sin leer, %lu capturas desbordadas\n",
+                  (unsigned long)s.lost_records, (unsigned long)pulse_capture_overflows);
+  }
+  if (s.matched == 0) return;
+
+  double mean_us = (double)s.sum_latency_us / s.matched;
+  double variance = (double)s.sum_sq_latency_us / s.matched - mean_us * mean_us;
+  Serial.printf("Latencia: media %.2f us | desv %.2f us | min %lu us | max %lu us\n", mean_us,
+                variance > 0 ? sqrt(variance) : 0.0, (unsigned long)s.min_latency_us,
+                (unsigned long)s.max_latency_us);
+
+  Serial.println("Histograma latencia:");
+  uint32_t lower_us = 0;
+  for (int i = 0; i < LOOPBACK_HIST_BINS; i++) {
+    if (i < LOOPBACK_HIST_BINS - 1) {
+      Serial.printf("  %4lu-%4lu us: %lu\n", (unsigned long)lower_us,
+                    (unsigned long)LOOPBACK_HIST_LIMITS_US[i] - 1, (unsigned long)s.histogram[i]);
+      lower_us = LOOPBACK_HIST_LIMITS_US[i];
+    } else {
+      Serial.printf("  >=%lu us: %lu\n", (unsigned long)lower_us, (unsigned long)s.histogram[i]);
+    }
+  }
+
+  if (s.period_count > 0) {
+    Serial.printf("Período capturado vs planificado: error medio %.2f us | max %lu us (%lu períodos)\n",
+                  (double)s.sum_period_error_us / s.period_count,
+                  (unsigned long)s.max_abs_period_error_us, (unsigned long)s.period_count);
+  }
+}
+#endif
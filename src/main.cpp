@@ -1,5 +1,4 @@
 #include <Arduino.h>
-#include <Wire.h>
 #include "config.h"
 #include "common.h"
 #include "display.h"
@@ -8,6 +7,13 @@
 #include "mode_pressure.h"
 #include "mode_recirculator.h"
 #include "mode_wifi.h"
+#include "pulse_output.h"
+#include "serial_cmd.h"
+#include "pattern_storage.h"
+#include "loopback_test.h"
+#include "flow_totalizer.h"
+#include "pressure_sensor.h"
+#include "pressure_calibration.h"
 
 // Declaraciones forward para funciones del modo
 void cambiarModo(SystemMode nuevo_modo);
@@ -39,8 +45,8 @@ void setup() {
   attachInterrupt(digitalPinToInterrupt(SENSOR_PIN), pulseInterrupt, RISING);
 
   // Inicializar I2C para el sensor de presión
-  Wire.begin(I2C_SDA, I2C_SCL);
-  Wire.setClock(100000);
+  sensorPresionIniciar();
+  calibracionPresionIniciar();
   Serial.println("I2C inicializado para sensor de presión WNK1MA");
 
   tft.init();
@@ -48,9 +54,11 @@ void setup() {
   tft.fillScreen(TFT_BLACK);
 
   // Inicializar módulos
+  inicializarAlmacenPatrones();
   inicializarGrafico();
   inicializarGenerador();
   inicializarRecirculador();
+  TotalizerSource totalizer_source = totalizadorIniciar(millis());
   
   // Leer y mostrar voltaje inicial
   voltaje = leerVoltaje();
@@ -66,11 +74,13 @@ void setup() {
   Serial.println("GPIO21 - Sensor/Generador configurado");
   Serial.println("GPIO32/22 - I2C para sensor de presión WNK1MA (SDA/SCL)");
   Serial.println("GPIO15/12/17/13 - Recirculador (Temp/Relé/Buzzer/LED)");
-  Serial.println("Botón IZQUIERDO: Toggle bomba / Cambiar página WiFi");
+  Serial.println("Botón IZQUIERDO: Referencia READ / Test case WRITE / Toggle bomba / Cambiar página WiFi");
   Serial.println("Botón DERECHO: Ciclar READ->WRITE->PRESSURE->RECIR->WiFi->READ");
   Serial.println("Sleep automático: 5 minutos sin actividad de BOTONES");
   Serial.println("Escala gráfico: 0-75Hz (fija) / AUTO (presión)");
   Serial.println("Modo inicial: LECTURA");
+  Serial.printf("Totalizador: %.3f L, %llu pulsos (recuperado de %s)\n", totalizadorLitros(),
+                (unsigned long long)totalizer_totals.pulses, totalizadorNombreOrigen(totalizer_source));
   
   if (waking_from_sleep) {
     Serial.println("Sistema reactivado desde sleep");
@@ -85,6 +95,16 @@ void cambiarModo(SystemMode nuevo_modo) {
   
   updateUserActivity();
   
+  // Parar el motor de pulsos antes de liberar el pin
+  if (modo_anterior == MODE_WRITE) {
+    pulseOutputDetener();
+    loopbackActivar(false);
+  } else if (modo_anterior == MODE_READ) {
+    finalizarModoRead();
+  } else if (modo_anterior == MODE_PRESSURE) {
+    finalizarModoPressure();
+  }
+  
   switch (nuevo_modo) {
     case MODE_READ:
       inicializarModoRead();
@@ -98,19 +118,9 @@ void cambiarModo(SystemMode nuevo_modo) {
       detachInterrupt(digitalPinToInterrupt(SENSOR_PIN));
       pinMode(SENSOR_PIN, OUTPUT);
       digitalWrite(SENSOR_PIN, LOW);
+      pulseOutputBegin(WRITE_CHANNEL_PINS, WRITE_CHANNEL_COUNT);
       inicializarGenerador();
-      tft.fillScreen(TFT_BLACK);
-      tft.setTextColor(TFT_YELLOW);
-      tft.setTextSize(2);
-      tft.setTextFont(2);
-      tft.setTextDatum(TL_DATUM);
-      tft.drawString(TEST_CASE_NAMES[current_test], 5, 5);
-      inicializarGrafico();
-      for (int i = 0; i < pulse_pattern.freq_count && i < GRAPH_WIDTH; i++) {
-        actualizarGrafico(pulse_pattern.frequencies[i]);
-      }
-      // Mostrar modo DESPUÉS de dibujar todo (voltaje desactivado en WRITE)
-      mostrarModo();
+      redibujarPantallaWrite(TEST_CASE_NAMES[current_test]);
       Serial.println("Cambiado a MODO ESCRITURA - Voltaje desactivado");
       break;
       
@@ -151,7 +161,9 @@ void cambiarModo(SystemMode nuevo_modo) {
 void manejarBotonIzquierdo() {
   updateUserActivity();
   
-  if (current_mode == MODE_WRITE) {
+  if (current_mode == MODE_READ) {
+    manejarBotonIzquierdoRead();
+  } else if (current_mode == MODE_WRITE) {
     manejarBotonIzquierdoWrite();
   } else if (current_mode == MODE_RECIRCULATOR) {
     manejarBotonIzquierdoRecirculator();
@@ -218,6 +230,12 @@ void loop() {
     }
   }
 
+  // Comandos por serial (dump de telemetría, etc.)
+  procesarComandosSerial();
+
+  // Persistencia del totalizador (limitada a unas pocas escrituras por hora)
+  totalizadorServicio(current_time);
+
   // Ejecutar lógica según modo actual
   switch (current_mode) {
     case MODE_READ:
@@ -1,81 +1,283 @@
 #include "mode_pressure.h"
 #include "display.h"
-#include <float.h>
+#include "pressure_sensor.h"
+#include "pressure_sampler.h"
+#include "pressure_calibration.h"
+#include "sliding_extrema.h"
+#include "pressure_trigger.h"
+#include <math.h>
 
 // Variables específicas del modo PRESSURE
 float pressure_graph_data[GRAPH_WIDTH];
 int pressure_graph_index = 0;
 float pressure_min_scale = 0.0;
 float pressure_max_scale = 100.0;
-float pressure_historical_min = FLT_MAX;
-float pressure_historical_max = FLT_MIN;
-bool pressure_history_initialized = false;
+bool pressure_scale_valid = false;
+uint32_t pressure_scale_window_ms = PRESSURE_SCALE_WINDOW_MS;
+uint32_t pressure_scale_changes = 0;
 unsigned long last_pressure_read = 0;
 bool pressure_auto_scale = true;
+QuantileSketch pressure_sketch;
+QuantileSummary pressure_summary;
+bool pressure_burst = false;
+uint32_t pressure_burst_period_us = PRESSURE_BURST_PERIOD_US;
+int pressure_burst_decimation = PRESSURE_BURST_DECIMATION;
+int pressure_burst_cic_order = PRESSURE_BURST_CIC_ORDER;
+PressureAcquisitionReport pressure_report;
+uint32_t pressure_last_raw = 0;
+int pressure_capture_view = -1;
+int pressure_capture_zoom = 1;
 
-WNK1MA_Reading readWNK1MA() {
-    WNK1MA_Reading reading;
-    reading.isValid = false;
-    reading.timestamp = millis();
+// Media y varianza en una pasada (Welford), una por ventana de informe
+struct NoiseAccumulator {
+  uint32_t count;
+  double mean;
+  double m2;
+};
 
-    Wire.beginTransmission(WNK1MA_ADDR);
-    Wire.write(WNK1MA_CMD);
-    if (Wire.endTransmission(true) != 0) {
-        Serial.println("[ERROR] I2C endTransmission failed");
-        return reading;
-    }
-    
-    delayMicroseconds(300);
-
-    uint8_t bytesRead = Wire.requestFrom(WNK1MA_ADDR, 3);
-    if (bytesRead == 3) {
-        uint32_t raw = (Wire.read() << 16) | (Wire.read() << 8) | Wire.read();
-        if (raw > 0 && raw < 16777215) {
-            reading.rawValue = raw;
-            reading.isValid = true;
-        }
-    } else {
-        Serial.printf("[ERROR] I2C requestFrom failed, expected 3 bytes, got %d\n", bytesRead);
-    }
-    return reading;
+static NoiseAccumulator noise_raw;
+static NoiseAccumulator noise_output;
+static PressureSample export_buffer[PRESSURE_EXPORT_MAX];
+static int export_count = 0;
+static int export_target = 0;
+static SlidingExtrema scale_extrema;
+static bool capture_view_dirty = false;
+
+static void acumularRuido(NoiseAccumulator* acc, uint32_t value) {
+  acc->count++;
+  double delta = value - acc->mean;
+  acc->mean += delta / acc->count;
+  acc->m2 += delta * (value - acc->mean);
+}
+
+// Desviación típica de la ventana; deja el acumulador listo para la siguiente
+static float cerrarRuido(NoiseAccumulator* acc) {
+  float sigma = (acc->count > 1) ? (float)sqrt(acc->m2 / (acc->count - 1)) : 0.0f;
+  acc->count = 0;
+  acc->mean = 0.0;
+  acc->m2 = 0.0;
+  return sigma;
+}
+
+// (Re)arranca la tarea de muestreo con la configuración actual
+static bool aplicarMuestreoPresion() {
+  muestreoPresionDetener();
+  cerrarRuido(&noise_raw);
+  cerrarRuido(&noise_output);
+  memset(&pressure_report, 0, sizeof(pressure_report));
+  if (pressure_burst) {
+    sensorPresionReloj(I2C_FAST_CLOCK_HZ);
+    return muestreoPresionIniciar(pressure_burst_period_us, pressure_burst_cic_order, pressure_burst_decimation);
+  }
+  sensorPresionReloj(I2C_CLOCK_HZ);
+  return muestreoPresionIniciar(PRESSURE_READ_INTERVAL_MS * 1000UL, 1, 1);
+}
+
+void reiniciarEscalaPresion() {
+  pressure_scale_valid = false;
+  pressure_scale_changes = 0;
+  if (pressure_scale_window_ms == 0) {
+    extremosIniciarMuestras(&scale_extrema, GRAPH_WIDTH);
+  } else {
+    extremosIniciarTiempo(&scale_extrema, pressure_scale_window_ms);
+  }
+}
+
+bool configurarVentanaEscalaPresion(uint32_t window_ms) {
+  if (window_ms != 0 && (window_ms < SLIDING_EXTREMA_BLOCKS || window_ms > PRESSURE_SCALE_WINDOW_MAX_MS)) {
+    return false;
+  }
+  pressure_scale_window_ms = window_ms;
+  reiniciarEscalaPresion();
+  return true;
 }
 
 void inicializarModoPressure() {
-  Wire.begin(I2C_SDA, I2C_SCL);
-  Wire.setClock(100000);
-  pressure_history_initialized = false;
-  pressure_historical_min = FLT_MAX;
-  pressure_historical_max = FLT_MIN;
+  sensorPresionIniciar();
+  reiniciarEscalaPresion();
+  cuantilesIniciar(&pressure_sketch, quantile_window_ms, millis());
+  pressure_summary.count = 0;
   Serial.println("I2C inicializado para sensor de presión WNK1MA");
-  Serial.println("Modo PRESSURE inicializado - Histórico reseteado");
+  if (!aplicarMuestreoPresion()) {
+    Serial.println("[ERROR] No se pudo iniciar la tarea de muestreo de presión");
+  }
+  Serial.println("Modo PRESSURE inicializado - Escala reiniciada");
 }
 
-void actualizarHistoricoPresion(float nuevo_valor) {
-  if (!pressure_history_initialized) {
-    pressure_historical_min = nuevo_valor;
-    pressure_historical_max = nuevo_valor;
-    pressure_history_initialized = true;
-  } else {
-    if (nuevo_valor < pressure_historical_min) {
-      pressure_historical_min = nuevo_valor;
-    }
-    if (nuevo_valor > pressure_historical_max) {
-      pressure_historical_max = nuevo_valor;
+void finalizarModoPressure() {
+  muestreoPresionDetener();
+  disparoPresionDetener();
+  pressure_capture_view = -1;
+}
+
+bool configurarRafagaPresion(bool burst, uint32_t period_us, int decimation, int cic_order) {
+  if (burst) {
+    if (period_us < PRESSURE_BURST_MIN_PERIOD_US || decimation < 1 || decimation > CIC_MAX_DECIMATION ||
+        cic_order < 1 || cic_order > CIC_MAX_ORDER) {
+      return false;
     }
+    pressure_burst_period_us = period_us;
+    pressure_burst_decimation = decimation;
+    pressure_burst_cic_order = cic_order;
+  }
+  pressure_burst = burst;
+  if (current_mode == MODE_PRESSURE && !aplicarMuestreoPresion()) {
+    Serial.println("[ERROR] No se pudo iniciar la tarea de muestreo de presión");
+  }
+  return true;
+}
+
+void mostrarAdquisicionPresion() {
+  if (pressure_burst) {
+    Serial.printf("Adquisición: ráfaga, I2C %lu kHz, período %lu us (%.0f Hz), CIC orden %d / %d (%.1f Hz)\n",
+                  (unsigned long)(I2C_FAST_CLOCK_HZ / 1000), (unsigned long)pressure_burst_period_us,
+                  1000000.0f / pressure_burst_period_us, pressure_burst_cic_order, pressure_burst_decimation,
+                  1000000.0f / pressure_burst_period_us / pressure_burst_decimation);
+  } else {
+    Serial.printf("Adquisición: normal, I2C %lu kHz, %d Hz\n", (unsigned long)(I2C_CLOCK_HZ / 1000),
+                  1000 / PRESSURE_READ_INTERVAL_MS);
   }
+  if (current_mode != MODE_PRESSURE) {
+    Serial.println("(se aplica al entrar en modo PRESSURE)");
+    return;
+  }
+  Serial.printf("Medido: %.1f Hz completa, %.1f Hz pantalla | Ruido: %.1f cuentas completa, %.1f tras CIC | CPU: %.1f%%\n",
+                pressure_report.rate_hz, pressure_report.output_hz, pressure_report.noise_raw,
+                pressure_report.noise_output, pressure_report.cpu_percent);
+  Serial.printf("Plazos perdidos %lu, errores %lu, desbordes %lu/%lu, latencia máx %lu us, período máx %lu us\n",
+                (unsigned long)pressure_sampler_stats.missed, (unsigned long)pressure_sampler_stats.errors,
+                (unsigned long)pressure_sampler_stats.raw_overflows, (unsigned long)pressure_sampler_stats.overflows,
+                (unsigned long)pressure_sampler_stats.max_latency_us,
+                (unsigned long)pressure_sampler_stats.max_work_us);
+}
+
+void exportarPresion(int count) {
+  if (count < 1) count = 1;
+  if (count > PRESSURE_EXPORT_MAX) count = PRESSURE_EXPORT_MAX;
+  export_count = 0;
+  export_target = count;
+  Serial.printf("Capturando %d muestras a tasa completa...\n", count);
+}
+
+static void imprimirMuestraPresion(int n, const PressureSample& sample, bool calibrated) {
+  Serial.printf("%d,%lu,%lu", n, (unsigned long)sample.t_us, (unsigned long)sample.raw);
+  if (calibrated) Serial.printf(",%ld", (long)calibracionPresionPa(sample.raw));
+  Serial.println();
+}
+
+static void volcarExportacion() {
+  bool calibrated = calibracionPresionActiva();
+  Serial.println(calibrated ? "n,t_us,raw,pa" : "n,t_us,raw");
+  for (int i = 0; i < export_count; i++) {
+    imprimirMuestraPresion(i, export_buffer[i], calibrated);
+  }
+  Serial.println("# fin");
+  export_target = 0;
+}
+
+const char* nombreDisparoPresion(PressureTriggerMode mode) {
+  switch (mode) {
+    case PRESSURE_TRIGGER_LEVEL: return "nivel";
+    case PRESSURE_TRIGGER_SLOPE: return "salto";
+    case PRESSURE_TRIGGER_RATE: return "dP/dt";
+    case PRESSURE_TRIGGER_PULSE: return "pulso";
+  }
+  return "?";
+}
+
+// n relativo al disparo (negativo antes)
+bool volcarCapturaPresion(int age) {
+  const PressureCapture* capture = disparoPresionCaptura(age);
+  if (!capture) return false;
   
-  float range = pressure_historical_max - pressure_historical_min;
+  bool calibrated = calibracionPresionActiva();
+  Serial.printf("# captura %lu (%s), disparo en t_us=%lu, %d muestras antes y %d desde el disparo\n",
+                (unsigned long)capture->seq, nombreDisparoPresion(capture->mode),
+                (unsigned long)capture->trigger_t_us, capture->pre, capture->length - capture->pre);
+  Serial.println(calibrated ? "n,t_us,raw,pa" : "n,t_us,raw");
+  for (int i = 0; i < capture->length; i++) {
+    imprimirMuestraPresion(i - capture->pre, capturaPresionMuestra(capture, i), calibrated);
+  }
+  Serial.println("# fin");
+  return true;
+}
+
+bool verCapturaPresion(int age, int zoom) {
+  if (age >= 0 && !disparoPresionCaptura(age)) return false;
+  if (zoom < 1 || zoom > PRESSURE_CAPTURE_MAX_ZOOM) return false;
+  pressure_capture_view = age;
+  pressure_capture_zoom = zoom;
+  capture_view_dirty = true;
+  return true;
+}
+
+// Tasa, ruido y CPU de la última ventana PRESSURE_REPORT_INTERVAL_MS
+static void actualizarInformePresion(unsigned long current_time) {
+  static unsigned long window_start = 0;
+  static uint32_t window_samples = 0;
+  static uint32_t window_outputs = 0;
+  static uint32_t window_busy_us = 0;
+  
+  unsigned long elapsed_ms = current_time - window_start;
+  if (elapsed_ms < PRESSURE_REPORT_INTERVAL_MS) return;
+  
+  uint32_t samples = pressure_sampler_stats.samples;
+  uint32_t outputs = pressure_sampler_stats.outputs;
+  uint32_t busy_us = pressure_sampler_stats.busy_us;
+  // El primer cierre tras reiniciar la tarea mezcla contadores: se descarta
+  if (samples >= window_samples && outputs >= window_outputs) {
+    pressure_report.rate_hz = (samples - window_samples) * 1000.0f / elapsed_ms;
+    pressure_report.output_hz = (outputs - window_outputs) * 1000.0f / elapsed_ms;
+    pressure_report.cpu_percent = (busy_us - window_busy_us) / (elapsed_ms * 10.0f);
+    pressure_report.noise_raw = cerrarRuido(&noise_raw);
+    pressure_report.noise_output = cerrarRuido(&noise_output);
+  }
+  window_start = current_time;
+  window_samples = samples;
+  window_outputs = outputs;
+  window_busy_us = busy_us;
+}
+
+// La escala sigue al mín./máx. de la ventana, pero con histéresis: se
+// amplía en cuanto un valor se sale y solo se encoge cuando los datos
+// ocupan menos de PRESSURE_SCALE_SHRINK de ella. Cada cambio deja
+// PRESSURE_SCALE_MARGIN de holgura, así una deriva lenta o el ruido no la
+// mueven en cada muestra.
+void actualizarEscalaPresion(float nuevo_valor, uint32_t now_ms) {
+  extremosAgregar(&scale_extrema, nuevo_valor, now_ms);
+  float window_min, window_max;
+  if (!extremosLeer(&scale_extrema, now_ms, &window_min, &window_max)) return;
+  
+  float range = window_max - window_min;
+  float span = pressure_max_scale - pressure_min_scale;
+  bool outside = !pressure_scale_valid || window_min < pressure_min_scale || window_max > pressure_max_scale;
+  if (!outside && range >= span * PRESSURE_SCALE_SHRINK) return;
+  
+  float new_min, new_max;
   if (range > 0) {
-    pressure_min_scale = pressure_historical_min - (range * 0.05);
-    pressure_max_scale = pressure_historical_max + (range * 0.05);
+    new_min = window_min - (range * PRESSURE_SCALE_MARGIN);
+    new_max = window_max + (range * PRESSURE_SCALE_MARGIN);
   } else {
-    pressure_min_scale = pressure_historical_min - 10.0;
-    pressure_max_scale = pressure_historical_max + 10.0;
+    new_min = window_min - 10.0;
+    new_max = window_max + 10.0;
   }
+  // Señal plana: ya está en el rango mínimo, no hay nada que encoger
+  if (!outside && new_max - new_min >= span) return;
+  
+  pressure_min_scale = new_min;
+  pressure_max_scale = new_max;
+  pressure_scale_valid = true;
+  pressure_scale_changes++;
 }
 
-void actualizarGraficoPresion(float nuevo_valor) {
-  actualizarHistoricoPresion(nuevo_valor);
+void actualizarGraficoPresion(float nuevo_valor, uint32_t now_ms) {
+  actualizarEscalaPresion(nuevo_valor, now_ms);
+  if (pressure_capture_view >= 0) {
+    // La captura ocupa el gráfico: el histórico se sigue llenando sin dibujarlo
+    pressure_graph_data[pressure_graph_index] = nuevo_valor;
+    pressure_graph_index = (pressure_graph_index + 1) % GRAPH_WIDTH;
+    return;
+  }
   actualizarGraficoGenerico(pressure_graph_data, &pressure_graph_index, nuevo_valor,
                             pressure_min_scale, pressure_max_scale,
                             TFT_BLUE, TFT_MAGENTA, pressure_auto_scale);
@@ -84,52 +286,114 @@ void actualizarGraficoPresion(float nuevo_valor) {
 void manejarModoPressure() {
   unsigned long current_time = millis();
   
-  if (current_time - last_pressure_read >= PRESSURE_READ_INTERVAL_MS) {
-    WNK1MA_Reading reading = readWNK1MA();
+  // Las muestras llegan de la tarea de muestreo (pressure_sampler.h): aquí
+  // solo se vacían los anillos, así un gráfico lento no retrasa el muestreo
+  PressureSample sample;
+  while (muestreoPresionLeerCompleta(&sample)) {
+    acumularRuido(&noise_raw, sample.raw);
+    disparoPresionAgregar(sample);
+    if (export_target > 0) {
+      export_buffer[export_count++] = sample;
+      if (export_count >= export_target) volcarExportacion();
+    }
+  }
+  
+  while (muestreoPresionLeer(&sample)) {
+    acumularRuido(&noise_output, sample.raw);
+    pressure_last_raw = sample.raw;
+    float pressure_value = calibracionPresionValor(sample.raw);
+    actualizarGraficoPresion(pressure_value, current_time);
+    cuantilesAgregar(&pressure_sketch, sample.raw, current_time);
+    last_pressure_read = current_time;
     
-    if (reading.isValid) {
-      float pressure_value = (float)reading.rawValue;
-      actualizarGraficoPresion(pressure_value);
-      
-      static float last_stable_pressure = 0.0;
-      if (abs(pressure_value - last_stable_pressure) > 10.0) {
-        last_stable_pressure = pressure_value;
-      }
-      
-      static unsigned long last_serial_time = 0;
-      if (current_time - last_serial_time >= SERIAL_DEBUG_INTERVAL_MS) {
-        Serial.print("PRESSURE - Raw: ");
-        Serial.print(reading.rawValue);
-        Serial.print(" | Value: ");
-        Serial.print(pressure_value, 1);
-        Serial.print(" | Range: ");
-        Serial.print(pressure_min_scale, 1);
-        Serial.print("-");
-        Serial.println(pressure_max_scale, 1);
-        last_serial_time = current_time;
-      }
-    } else {
-      static unsigned long last_error_time = 0;
-      if (current_time - last_error_time >= SERIAL_DEBUG_SLOW_MS) {
-        Serial.println("ERROR: No se puede leer el sensor de presión I2C");
-        last_error_time = current_time;
-      }
+    static float last_stable_pressure = 0.0;
+    if (abs(pressure_value - last_stable_pressure) > 10.0) {
+      last_stable_pressure = pressure_value;
     }
     
-    last_pressure_read = current_time;
+    static unsigned long last_serial_time = 0;
+    if (current_time - last_serial_time >= SERIAL_DEBUG_INTERVAL_MS) {
+      Serial.print("PRESSURE - Raw: ");
+      Serial.print(sample.raw);
+      Serial.print(" | Value: ");
+      Serial.print(pressure_value, 3);
+      Serial.print(" ");
+      Serial.print(calibracionPresionNombreUnidad());
+      Serial.print(" | Range: ");
+      Serial.print(pressure_min_scale, 1);
+      Serial.print("-");
+      Serial.print(pressure_max_scale, 1);
+      Serial.printf(" (%lu cambios)", (unsigned long)pressure_scale_changes);
+      Serial.printf(" | %.0f Hz, ruido %.1f/%.1f, CPU %.1f%%, plazos perdidos %lu",
+                    pressure_report.rate_hz, pressure_report.noise_raw, pressure_report.noise_output,
+                    pressure_report.cpu_percent, (unsigned long)pressure_sampler_stats.missed);
+      Serial.printf(" | I2C: %lu errores, %lu reintentos, %lu recuperaciones, máx %lu us\n",
+                    (unsigned long)pressure_sensor_stats.errors, (unsigned long)pressure_sensor_stats.retries,
+                    (unsigned long)pressure_sensor_stats.recoveries,
+                    (unsigned long)pressure_sensor_stats.max_busy_us);
+      last_serial_time = current_time;
+    }
   }
+  
+  actualizarInformePresion(current_time);
+  
+  static unsigned long last_summary_time = 0;
+  if (current_time - last_summary_time >= QUANTILE_SUMMARY_INTERVAL_MS) {
+    cuantilesResumen(&pressure_sketch, current_time, &pressure_summary);
+    last_summary_time = current_time;
+  }
+  
+  static uint32_t last_errors = 0;
+  static unsigned long last_error_time = 0;
+  if (pressure_sampler_stats.errors != last_errors && current_time - last_error_time >= SERIAL_DEBUG_SLOW_MS) {
+    Serial.printf("ERROR: No se puede leer el sensor de presión I2C (%lu lecturas perdidas, %lu recuperaciones del bus)\n",
+                  (unsigned long)pressure_sampler_stats.errors, (unsigned long)pressure_sensor_stats.recoveries);
+    last_errors = pressure_sampler_stats.errors;
+    last_error_time = current_time;
+  }
+}
+
+// Dibuja la captura seleccionada solo cuando cambia (nueva captura o zoom)
+static void mostrarCapturaPresion() {
+  static PressureCaptureView view;
+  static uint32_t drawn_seq = 0;
+  
+  const PressureCapture* capture = disparoPresionCaptura(pressure_capture_view);
+  if (!capture) {
+    // Hueco reutilizado por el disparo: se vuelve al gráfico en curso
+    pressure_capture_view = -1;
+    return;
+  }
+  if (!capture_view_dirty && capture->seq == drawn_seq) return;
+  
+  capturaPresionVista(capture, pressure_capture_zoom, &view);
+  dibujarCapturaPresion(&view);
+  drawn_seq = capture->seq;
+  capture_view_dirty = false;
+  
+  char capture_text[48];
+  snprintf(capture_text, sizeof(capture_text), "#%lu %s x%d %+.1f/%+.1f ms %.4g-%.4g", (unsigned long)capture->seq,
+           nombreDisparoPresion(capture->mode), pressure_capture_zoom, view.first_us / 1000.0f,
+           view.last_us / 1000.0f, view.scale_min, view.scale_max);
+  dibujarLineaInferior(capture_text, TFT_RED);
 }
 
 void mostrarInfoSensorPressure() {
   static float last_pressure_value = -1.0;
   static char last_phase_text[50] = "";
-  static char last_scale_text[20] = "";
+  static char last_scale_text[40] = "";
   
   float current_pressure = pressure_graph_data[(pressure_graph_index - 1 + GRAPH_WIDTH) % GRAPH_WIDTH];
   
   if (current_pressure != last_pressure_value) {
     char pressure_text[30];
-    snprintf(pressure_text, sizeof(pressure_text), "Presion: %.0f", current_pressure);
+    if (!calibracionPresionActiva()) {
+      snprintf(pressure_text, sizeof(pressure_text), "Presion: %.0f", current_pressure);
+    } else if (pressure_calibration.unit == PRESSURE_UNIT_BAR) {
+      snprintf(pressure_text, sizeof(pressure_text), "Presion: %.3f bar", current_pressure);
+    } else {
+      snprintf(pressure_text, sizeof(pressure_text), "Presion: %.2f kPa", current_pressure);
+    }
     tft.fillRect(5, 5, 160, 15, TFT_BLACK);
     tft.setTextColor(TFT_MAGENTA);
     tft.setTextSize(1);
@@ -138,7 +402,14 @@ void mostrarInfoSensorPressure() {
     last_pressure_value = current_pressure;
   }
   
-  const char* mode_text = "Sensor I2C @ 100Hz (Historico)";
+  char mode_text[50];
+  if (pressure_burst) {
+    snprintf(mode_text, sizeof(mode_text), "Rafaga %.0fHz CIC%d/%d  perdidos: %lu", pressure_report.rate_hz,
+             pressure_burst_cic_order, pressure_burst_decimation, (unsigned long)pressure_sampler_stats.missed);
+  } else {
+    snprintf(mode_text, sizeof(mode_text), "Sensor I2C @ %luHz  plazos perdidos: %lu",
+             (unsigned long)(1000 / PRESSURE_READ_INTERVAL_MS), (unsigned long)pressure_sampler_stats.missed);
+  }
   if (strcmp(mode_text, last_phase_text) != 0) {
     tft.fillRect(5, 25, 230, 10, TFT_BLACK);
     tft.setTextColor(TFT_DARKGREY);
@@ -148,13 +419,36 @@ void mostrarInfoSensorPressure() {
     strcpy(last_phase_text, mode_text);
   }
   
-  const char* scale_text = "Escala: HISTORICA";
+  char scale_text[40];
+  char window_text[12];
+  if (pressure_scale_window_ms == 0) {
+    strcpy(window_text, "visible");
+  } else {
+    snprintf(window_text, sizeof(window_text), "%lus", (unsigned long)(pressure_scale_window_ms / 1000));
+  }
+  snprintf(scale_text, sizeof(scale_text), "Escala: %.4g-%.4g (%s)", pressure_min_scale, pressure_max_scale,
+           window_text);
   if (strcmp(scale_text, last_scale_text) != 0) {
-    tft.fillRect(5, 52, 120, 8, TFT_BLACK);
+    tft.fillRect(5, 52, 180, 8, TFT_BLACK);
     tft.setTextColor(TFT_DARKGREY);
     tft.setTextSize(1);
     tft.setTextFont(1);
     tft.drawString(scale_text, 5, 52);
     strcpy(last_scale_text, scale_text);
   }
+  
+  if (pressure_capture_view >= 0) {
+    mostrarCapturaPresion();
+    return;
+  }
+  
+  char quantile_text[48];
+  if (calibracionPresionActiva()) {
+    // La calibración es no decreciente (pendienteValida): los cuantiles de las cuentas convertidos son los de la presión
+    formatearCuantilesConvertidos(&pressure_summary, calibracionPresionValor, calibracionPresionNombreUnidad(),
+                                  quantile_text, sizeof(quantile_text));
+  } else {
+    formatearCuantiles(&pressure_summary, 1.0f, "", quantile_text, sizeof(quantile_text));
+  }
+  dibujarLineaInferior(quantile_text, TFT_MAGENTA);
 }
@@ -1,40 +1,365 @@
 #include "mode_read.h"
 #include "display.h"
+#include "timestamp_ring.h"
+#include "pulse_counter.h"
+#include "edge_capture.h"
+#include "frequency_estimator.h"
+#include "flow_segmenter.h"
+#include "pattern_checker.h"
+#include "quantile_sketch.h"
+#include "flow_totalizer.h"
+#include "test_cases.h"
 
 // Variables específicas del modo READ
 volatile unsigned long pulse_count = 0;
 unsigned long last_pulse_count = 0;
 unsigned long last_pulse_time = 0;
 float pulse_frequency = 0.0;
+ReadPeriodStats read_period_stats;
+bool read_period_log = false;
+ReadBackend read_backend = (ReadBackend)READ_BACKEND_DEFAULT;
+FrequencyEstimator read_estimator;
+uint32_t read_flow_timeout_ms = READ_FLOW_TIMEOUT_MS;
+FlowSegmenter read_segmenter;
+FlowEvent read_events[SEGMENT_EVENT_LOG];  // Últimos eventos cerrados (circular)
+unsigned long read_event_count = 0;
+QuantileSketch read_period_sketch;
+QuantileSummary read_period_summary;
+PatternChecker read_checker;
+bool read_check_active = false;
+TestCase read_check_tc = TEST_CASE_1;
 
-// Función de interrupción para contar pulsos
+// Timestamps de cada flanco: la ISR produce, manejarModoRead consume
+static TimestampRing<READ_CAPTURE_RING_SIZE> read_ring;
+static uint32_t last_edge_us = 0;
+static bool have_last_edge = false;
+
+// Función de interrupción: cuenta el pulso y guarda su instante
 void IRAM_ATTR pulseInterrupt() {
   pulse_count++;
+  timestampRingInsertar(&read_ring, (uint32_t)micros());
+}
+
+// Backends con un timestamp por flanco (el PCNT solo da la cuenta)
+static bool backendConTimestamps() {
+  return read_backend != READ_BACKEND_PCNT;
+}
+
+static void reiniciarPeriodosRead() {
+  timestampRingVaciar(&read_ring);
+  have_last_edge = false;
+  read_period_stats.count = 0;
+  read_period_stats.last_us = 0;
+  read_period_stats.window_min_us = 0;
+  read_period_stats.window_max_us = 0;
+  read_period_stats.fragments = 0;
+  read_period_stats.overflows = 0;
+  read_period_stats.last_period_ticks = 0;
+  read_period_stats.last_width_ticks = 0;
+  read_period_stats.window_width_min_ticks = 0;
+  read_period_stats.window_width_max_ticks = 0;
+  cuantilesIniciar(&read_period_sketch, quantile_window_ms, millis());
+  read_period_summary.count = 0;
+}
+
+static void registrarPeriodoRead(uint32_t period_us) {
+  ReadPeriodStats* stats = &read_period_stats;
+  
+  // Fragmento: pulso partido o rebote, mucho más corto que el anterior
+  if (stats->last_us > 0 && (uint64_t)period_us * 100 < (uint64_t)stats->last_us * READ_FRAGMENT_PERCENT) {
+    stats->fragments++;
+  }
+  if (stats->window_min_us == 0 || period_us < stats->window_min_us) stats->window_min_us = period_us;
+  if (period_us > stats->window_max_us) stats->window_max_us = period_us;
+  stats->last_us = period_us;
+  stats->count++;
+  cuantilesAgregar(&read_period_sketch, period_us, millis());
+  
+  // Con MCPWM el volcado sale de los ticks (consumirCapturaFinaRead)
+  if (read_period_log && read_backend != READ_BACKEND_MCPWM) {
+    Serial.printf("%lu,%lu\n", stats->count, (unsigned long)period_us);
+  }
+}
+
+static uint16_t colorEvento(FlowEventType type) {
+  switch (type) {
+    case FLOW_EVENT_STARTUP: return TFT_BLUE;
+    case FLOW_EVENT_STABLE: return TFT_GREEN;
+    case FLOW_EVENT_TRANSITION: return TFT_YELLOW;
+    case FLOW_EVENT_STOP: return TFT_ORANGE;
+    case FLOW_EVENT_LEAK: return TFT_RED;
+  }
+  return TFT_DARKGREY;
+}
+
+static void imprimirEventoRead(unsigned long number, const FlowEvent* event) {
+  Serial.printf("#%lu flujo %lu %-10s %5lu pulsos %7lu ms  período medio %.1f ms%s\n",
+                number, (unsigned long)event->flow, segmentadorNombreTipo(event->type),
+                (unsigned long)event->pulses, (unsigned long)segmentadorDuracionMs(event),
+                segmentadorPeriodoMedioMs(event), event->timeout ? "  (fin de flujo)" : "");
+}
+
+// Evento cerrado: guardarlo, informar y marcar la frontera en el gráfico
+static void registrarEventoRead(const FlowEvent* event) {
+  read_events[read_event_count % SEGMENT_EVENT_LOG] = *event;
+  read_event_count++;
+  Serial.print("[EVENTO] ");
+  imprimirEventoRead(read_event_count, event);
+  marcarGrafico(colorEvento(event->type));
+}
+
+void mostrarEventosRead() {
+  if (read_event_count == 0) {
+    Serial.println("Sin eventos de flujo (modo READ, backend isr o mcpwm)");
+    return;
+  }
+  unsigned long first = (read_event_count > SEGMENT_EVENT_LOG) ? read_event_count - SEGMENT_EVENT_LOG : 0;
+  Serial.println("=== EVENTOS DE FLUJO ===");
+  for (unsigned long i = first; i < read_event_count; i++) {
+    imprimirEventoRead(i + 1, &read_events[i % SEGMENT_EVENT_LOG]);
+  }
+  if (read_segmenter.in_flow) {
+    Serial.printf("En curso: flujo %lu %s, %lu pulsos\n", (unsigned long)read_segmenter.current.flow,
+                  segmentadorNombreTipo(read_segmenter.current.type), (unsigned long)read_segmenter.current.pulses);
+  }
+}
+
+// Rearma la comparación con la referencia (al entrar en READ o al cambiarla)
+static void armarVerificacionRead() {
+  PatternStream stream;
+  int phase_count = 0;
+  const PulsePhase* phases = getTestPhases(read_check_tc, &phase_count);
+  if (!abrirPatron(read_check_tc, &stream)) {
+    read_check_active = false;
+    return;
+  }
+  verificadorIniciar(&read_checker, &stream, phases, phase_count);
+}
+
+void seleccionarReferenciaRead(bool enabled, TestCase tc) {
+  read_check_active = enabled;
+  read_check_tc = tc;
+  if (!enabled) {
+    Serial.println("Comparación con patrón desactivada");
+    return;
+  }
+  // La alineación empieza en el primer flanco: en READ se reinicia la medida
+  if (current_mode == MODE_READ) {
+    inicializarModoRead();
+  } else {
+    armarVerificacionRead();
+  }
+  if (!read_check_active) {
+    Serial.println("ERROR: no se pudo abrir el patrón de referencia");
+    return;
+  }
+  Serial.printf("Referencia %s: %lu períodos esperados (%.3f s)%s\n", TEST_CASE_NAMES[tc],
+                (unsigned long)read_checker.expected_periods, read_checker.expected_us / 1000000.0,
+                backendConTimestamps() ? "" : " - requiere backend isr o mcpwm");
+}
+
+// Botón izquierdo: sin referencia -> TC1 -> ... -> TC9 -> sin referencia
+void manejarBotonIzquierdoRead() {
+  if (!read_check_active) {
+    seleccionarReferenciaRead(true, TEST_CASE_1);
+  } else if (read_check_tc + 1 < NUM_TEST_CASES) {
+    seleccionarReferenciaRead(true, (TestCase)(read_check_tc + 1));
+  } else {
+    seleccionarReferenciaRead(false, read_check_tc);
+  }
+}
+
+void mostrarVerificacionRead() {
+  if (!read_check_active) {
+    Serial.println("Sin patrón de referencia (check <1-5|9>)");
+    return;
+  }
+  const PatternChecker* checker = &read_checker;
+  Serial.printf("=== CONFORMIDAD CON %s ===\n", TEST_CASE_NAMES[read_check_tc]);
+  Serial.printf("Veredicto: %s | esperados %lu/%lu | capturados %lu | perdidos %lu | de más %lu | erróneos %lu\n",
+                verificadorNombreVeredicto(verificadorVeredicto(checker)),
+                (unsigned long)checker->consumed, (unsigned long)checker->expected_periods,
+                (unsigned long)checker->captured, (unsigned long)checker->missed,
+                (unsigned long)checker->extra, (unsigned long)checker->mismatched);
+  if (checker->trailing > 0) {
+    Serial.printf("Períodos después del final del patrón: %lu\n", (unsigned long)checker->trailing);
+  }
+  if (checker->lost_sync) {
+    Serial.println("AVISO: timestamps perdidos (anillo lleno), alineación no fiable");
+  }
+  for (int p = 0; p < checker->stats_count; p++) {
+    const CheckPhaseStats* stats = &checker->stats[p];
+    const PulsePhase* phase = checker->phases ? &checker->phases[p] : nullptr;
+    Serial.printf("  F%-2d %-6s %6.1f->%6.1f ms  %5lu/%-5lu  perd %lu  más %lu  err %lu  sesgo %+.3f%%  máx %.1f%%  %s\n",
+                  p + 1, phase ? (phase->type == PHASE_STABLE ? "STABLE" : "TRANS") : "-",
+                  phase ? phase->tempo_start_ms : 0.0f, phase ? phase->tempo_end_ms : 0.0f,
+                  (unsigned long)stats->matched, (unsigned long)stats->expected,
+                  (unsigned long)stats->missed, (unsigned long)stats->extra, (unsigned long)stats->mismatched,
+                  verificadorSesgoPorciento(stats), stats->max_error_permille / 10.0,
+                  verificadorFaseConforme(stats) ? "ok" : "NO");
+  }
+}
+
+// Totales esperados de cada test case (para comparar con los logs del gateway)
+void mostrarTotalesTestCases() {
+  Serial.println("=== TOTALES ESPERADOS POR TEST CASE ===");
+  Serial.println("TC            pulsos  períodos  1er->último flanco  fases");
+  for (int i = 0; i < NUM_TEST_CASES; i++) {
+    PatternStream stream;
+    if (!abrirPatron((TestCase)i, &stream)) continue;
+    uint32_t pulses, periods;
+    uint64_t duration_us;
+    int phase_count = 0;
+    getTestPhases((TestCase)i, &phase_count);
+    verificadorTotales(&stream, &pulses, &periods, &duration_us);
+    Serial.printf("%-12s %7lu  %8lu  %16.3f s  %5d\n", TEST_CASE_NAMES[i], (unsigned long)pulses,
+                  (unsigned long)periods, duration_us / 1000000.0, phase_count);
+  }
+}
+
+// Vacía el anillo y convierte timestamps consecutivos en períodos
+static void consumirTimestampsRead() {
+  read_period_stats.overflows = read_ring.overflows;
+  
+  FlowEvent event;
+  uint32_t t_us;
+  bool gap;
+  while (timestampRingLeer(&read_ring, &t_us, &gap)) {
+    // Timestamps descartados con el anillo lleno justo antes de este: el
+    // período desde el anterior no es real (los ya en cola sí lo eran)
+    if (gap) {
+      have_last_edge = false;
+      frecuenciaDiscontinuidad(&read_estimator);
+      segmentadorDiscontinuidad(&read_segmenter);
+      if (read_check_active) verificadorDiscontinuidad(&read_checker);
+    }
+    frecuenciaFlanco(&read_estimator, t_us);
+    if (segmentadorPulso(&read_segmenter, t_us, &event)) {
+      registrarEventoRead(&event);
+    }
+    if (have_last_edge) {
+      registrarPeriodoRead(t_us - last_edge_us);
+      if (read_check_active) verificadorPeriodo(&read_checker, t_us - last_edge_us);
+    }
+    last_edge_us = t_us;
+    have_last_edge = true;
+  }
+}
+
+// Backend MCPWM: períodos y anchos con la resolución del contador de captura
+static void consumirCapturaFinaRead() {
+  ReadPeriodStats* stats = &read_period_stats;
+  uint32_t ticks;
+  
+  while (edgeCaptureLeerPeriodo(&ticks)) {
+    stats->last_period_ticks = ticks;
+    if (read_period_log) {
+      Serial.printf("P,%lu,%.4f\n", (unsigned long)edge_capture_stats.rising, edgeCaptureTicksAUs(ticks));
+    }
+  }
+  while (edgeCaptureLeerAncho(&ticks)) {
+    stats->last_width_ticks = ticks;
+    if (stats->window_width_min_ticks == 0 || ticks < stats->window_width_min_ticks) stats->window_width_min_ticks = ticks;
+    if (ticks > stats->window_width_max_ticks) stats->window_width_max_ticks = ticks;
+    if (read_period_log) {
+      Serial.printf("W,%lu,%.4f\n", (unsigned long)edge_capture_stats.falling, edgeCaptureTicksAUs(ticks));
+    }
+  }
+}
+
+const char* nombreBackendRead(ReadBackend backend) {
+  switch (backend) {
+    case READ_BACKEND_ISR: return "isr";
+    case READ_BACKEND_PCNT: return "pcnt";
+    case READ_BACKEND_MCPWM: return "mcpwm";
+  }
+  return "?";
 }
 
 void inicializarModoRead() {
   pinMode(SENSOR_PIN, INPUT);
-  attachInterrupt(digitalPinToInterrupt(SENSOR_PIN), pulseInterrupt, RISING);
+  // Un solo backend activo sobre el pin
+  detachInterrupt(digitalPinToInterrupt(SENSOR_PIN));
+  pulseCounterDetener();
+  edgeCaptureDetener();
+  reiniciarPeriodosRead();
+  
+  if (read_backend == READ_BACKEND_PCNT && !pulseCounterIniciar(SENSOR_PIN, PULSE_COUNTER_FILTER_NS)) {
+    Serial.println("ERROR: PCNT no disponible, se usa la interrupción GPIO");
+    read_backend = READ_BACKEND_ISR;
+  } else if (read_backend == READ_BACKEND_MCPWM && !edgeCaptureIniciar(SENSOR_PIN, &read_ring)) {
+    Serial.println("ERROR: captura MCPWM no disponible, se usa la interrupción GPIO");
+    read_backend = READ_BACKEND_ISR;
+  }
+  if (read_backend == READ_BACKEND_ISR) {
+    attachInterrupt(digitalPinToInterrupt(SENSOR_PIN), pulseInterrupt, RISING);
+  }
   
   // Resetear contadores al entrar en modo READ
   pulse_count = 0;
   last_pulse_count = 0;
   last_pulse_time = millis();
   pulse_frequency = 0.0;
+  frecuenciaIniciar(&read_estimator, backendConTimestamps(), read_flow_timeout_ms);
+  segmentadorIniciar(&read_segmenter, SEGMENT_TIMEOUT_MS);
+  read_event_count = 0;
+  if (read_check_active) {
+    armarVerificacionRead();
+  }
   
-  Serial.println("Modo READ inicializado - Contadores reseteados");
+  Serial.print("Modo READ inicializado - Contadores reseteados, backend ");
+  Serial.println(nombreBackendRead(read_backend));
+}
+
+// Al salir de READ: liberar PCNT / MCPWM (el pin puede pasar a salida)
+void finalizarModoRead() {
+  pulseCounterDetener();
+  edgeCaptureDetener();
+}
+
+void configurarTimeoutFlujoRead(uint32_t timeout_ms) {
+  read_flow_timeout_ms = timeout_ms;
+  frecuenciaTimeout(&read_estimator, timeout_ms);
+}
+
+// Cambia el backend de cuenta; en modo READ reinicia la medida
+void seleccionarBackendRead(ReadBackend backend) {
+  read_backend = backend;
+  if (current_mode == MODE_READ) {
+    inicializarModoRead();
+  }
 }
 
 void manejarModoRead() {
   unsigned long current_time = millis();
   
+  if (read_backend == READ_BACKEND_PCNT) {
+    pulse_count = (unsigned long)pulseCounterLeer();
+  } else {
+    if (read_backend == READ_BACKEND_MCPWM) {
+      pulse_count = edge_capture_stats.rising;
+      consumirCapturaFinaRead();
+    }
+    consumirTimestampsRead();
+    // Fin de flujo por timeout
+    FlowEvent event;
+    uint32_t now_us = (uint32_t)micros();
+    while (segmentadorTick(&read_segmenter, now_us, &event)) {
+      registrarEventoRead(&event);
+    }
+  }
+  
   // Actualizar gráfico con frecuencia leída
   if (current_time - last_pulse_time >= PULSE_CALC_INTERVAL_MS) {
+    // Recíproco a tasas bajas, por ventana a tasas altas (frequency_estimator.h)
     unsigned long pulses_in_interval = pulse_count - last_pulse_count;
-    pulse_frequency = (pulses_in_interval * 1000.0) / (current_time - last_pulse_time);
+    pulse_frequency = frecuenciaActualizar(&read_estimator, (uint32_t)micros(), pulses_in_interval,
+                                           (current_time - last_pulse_time) * 1000);
+    totalizadorSumar((uint32_t)pulses_in_interval, pulse_frequency);
     
     // Actualizar gráfico con frecuencia leída
     actualizarGrafico(pulse_frequency);
+    cuantilesResumen(&read_period_sketch, current_time, &read_period_summary);
     
     last_pulse_count = pulse_count;
     last_pulse_time = current_time;
@@ -46,7 +371,36 @@ void manejarModoRead() {
       Serial.print(pulse_count);
       Serial.print(" | Freq: ");
       Serial.print(pulse_frequency, 2);
-      Serial.println(" Hz");
+      Serial.print(" Hz (");
+      Serial.print(frecuenciaNombreMetodo(read_estimator.method));
+      Serial.print(")");
+      if (read_backend == READ_BACKEND_PCNT) {
+        Serial.print(" | PCNT, vueltas: ");
+        Serial.println(pulse_counter_wraps);
+      } else {
+        Serial.print(" | Período: ");
+        Serial.print(read_period_stats.last_us);
+        Serial.print(" us (");
+        Serial.print(read_period_stats.window_min_us);
+        Serial.print("-");
+        Serial.print(read_period_stats.window_max_us);
+        Serial.print(")");
+        if (read_backend == READ_BACKEND_MCPWM) {
+          Serial.printf(" | MCPWM: período %.3f us, ancho %.3f us (%.3f-%.3f)",
+                        edgeCaptureTicksAUs(read_period_stats.last_period_ticks),
+                        edgeCaptureTicksAUs(read_period_stats.last_width_ticks),
+                        edgeCaptureTicksAUs(read_period_stats.window_width_min_ticks),
+                        edgeCaptureTicksAUs(read_period_stats.window_width_max_ticks));
+          read_period_stats.window_width_min_ticks = 0;
+          read_period_stats.window_width_max_ticks = 0;
+        }
+        Serial.print(" | Fragmentos: ");
+        Serial.print(read_period_stats.fragments);
+        Serial.print(" | Desbordes: ");
+        Serial.println(read_period_stats.overflows);
+        read_period_stats.window_min_us = 0;
+        read_period_stats.window_max_us = 0;
+      }
       last_serial_time = current_time;
     }
   }
@@ -60,7 +414,7 @@ void mostrarInfoSensorRead() {
   
   // Mostrar frecuencia leída
   char freq_text[30];
-  snprintf(freq_text, sizeof(freq_text), "Freq: %.1f Hz", pulse_frequency);
+  snprintf(freq_text, sizeof(freq_text), "Freq: %.1f Hz %.2f L", pulse_frequency, totalizadorLitros());
   if (strcmp(freq_text, last_freq_text) != 0) {
     tft.fillRect(5, 5, 160, 15, TFT_BLACK);
     tft.setTextColor(TFT_YELLOW);
@@ -72,7 +426,12 @@ void mostrarInfoSensorRead() {
   
   // Mostrar total de pulsos
   char total_text[30];
-  snprintf(total_text, sizeof(total_text), "Total: %lu", pulse_count);
+  if (backendConTimestamps()) {
+    snprintf(total_text, sizeof(total_text), "Total: %lu %s", pulse_count,
+             read_segmenter.in_flow ? segmentadorNombreTipo(read_segmenter.current.type) : "IDLE");
+  } else {
+    snprintf(total_text, sizeof(total_text), "Total: %lu", pulse_count);
+  }
   if (strcmp(total_text, last_total_text) != 0) {
     tft.fillRect(5, 25, 160, 15, TFT_BLACK);
     tft.setTextColor(TFT_GREEN);
@@ -82,6 +441,29 @@ void mostrarInfoSensorRead() {
     strcpy(last_total_text, total_text);
   }
   
+  // Bajo el gráfico: veredicto de la comparación con la referencia o, sin
+  // referencia, cuantiles del período en la ventana
+  char bottom_text[48];
+  uint16_t bottom_color = TFT_DARKGREY;
+  if (read_check_active) {
+    CheckVerdict verdict = verificadorVeredicto(&read_checker);
+    snprintf(bottom_text, sizeof(bottom_text), "%.3s %-6s %lu/%lu  -%lu +%lu x%lu",
+             TEST_CASE_NAMES[read_check_tc], verificadorNombreVeredicto(verdict),
+             (unsigned long)read_checker.consumed, (unsigned long)read_checker.expected_periods,
+             (unsigned long)read_checker.missed, (unsigned long)read_checker.extra,
+             (unsigned long)read_checker.mismatched);
+    if (verdict == CHECK_PASS || verdict == CHECK_RUNNING) {
+      bottom_color = TFT_GREEN;
+    } else if (verdict == CHECK_FAIL || verdict == CHECK_FAILING) {
+      bottom_color = TFT_RED;
+    }
+  } else if (backendConTimestamps()) {
+    formatearCuantiles(&read_period_summary, 0.001f, " ms", bottom_text, sizeof(bottom_text));
+  } else {
+    bottom_text[0] = '\0';
+  }
+  dibujarLineaInferior(bottom_text, bottom_color);
+  
   // Mostrar escala fija del gráfico
   char scale_text[20];
   snprintf(scale_text, sizeof(scale_text), "Max: %dHz", (int)max_freq_scale);
@@ -1,5 +1,11 @@
 #include "mode_write.h"
 #include "display.h"
+#include "pulse_output.h"
+#include "pulse_telemetry.h"
+#include "test_cases.h"
+#include "pattern_storage.h"
+#include "loopback_test.h"
+#include "pulse_capture.h"
 
 // Variables específicas del modo WRITE
 bool generating_pulse = false;
@@ -12,85 +18,18 @@ bool pulse_state = false;
 unsigned long pulse_count_generated = 0;
 TestCase current_test = TEST_CASE_1;
 unsigned long test_start_time = 0;
-PulsePattern pulse_pattern;
+PatternTable pulse_pattern;  // Resumen del patrón activo
+PatternPreview write_preview;  // Vista previa del canal 0
+WriteChannel write_channels[WRITE_CHANNEL_COUNT];  // Canal 0 = test case activo en SENSOR_PIN
+const uint8_t WRITE_CHANNEL_PINS[WRITE_CHANNEL_COUNT] = {SENSOR_PIN, WRITE_CHANNEL_PIN_1, WRITE_CHANNEL_PIN_2};
 int current_pulse_index = 0;
 bool pattern_ready = false;
 
-// Variables de timing en microsegundos
-unsigned long next_pulse_time_us = 0;
-unsigned long last_pulse_ts_us = 0;
-unsigned long pulse_end_time_us = 0;  // Tiempo en que debe terminar el pulso HIGH
+bool pattern_from_file = false;  // Canal 0 reproduce un fichero de LittleFS
+char pattern_file_name[32] = "";
 
-// Arrays de fases para cada test case
-// TC1: Arranque/Parada Rápidos (~1.5s)
-PulsePhase test1_phases[] = {
-  {PHASE_TRANSITION, 75.0, 43.0, 4, 3.0},   // Aceleración: 75→43ms, 4 pulsos
-  {PHASE_TRANSITION, 43.0, 90.0, 5, 3.0}    // Frenado: 43→90ms, 5 pulsos
-};
-
-// TC2: Normal - Arranque-Estable-Parada (~6s)
-PulsePhase test2_phases[] = {
-  {PHASE_TRANSITION, 81.0, 48.0, 10, 3.0},  // Aceleración: 81→48ms, 10 pulsos
-  {PHASE_STABLE, 49.0, 49.0, 60, 4.0},      // Estable: 49ms, 60 pulsos (~3s)
-  {PHASE_TRANSITION, 49.0, 97.0, 15, 3.0}   // Frenado: 49→97ms, 15 pulsos
-};
-
-// TC3: Evento Compuesto - Grifo Adicional (~8.5s)
-PulsePhase test3_phases[] = {
-  {PHASE_TRANSITION, 73.0, 53.0, 8, 3.0},   // Aceleración inicial: 73→53ms
-  {PHASE_STABLE, 53.0, 53.0, 28, 4.0},      // Flujo bajo: 53ms, 28 pulsos
-  {PHASE_TRANSITION, 53.0, 28.0, 8, 3.0},   // Aceleración: 53→28ms (se abre más)
-  {PHASE_STABLE, 28.0, 28.0, 71, 4.0},      // Flujo alto: 28ms, 71 pulsos (~2s)
-  {PHASE_TRANSITION, 28.0, 55.0, 10, 3.0},  // Desaceleración: 28→55ms (cierra grifo)
-  {PHASE_STABLE, 55.0, 55.0, 27, 4.0},      // Flujo bajo: 55ms, 27 pulsos
-  {PHASE_TRANSITION, 55.0, 100.0, 12, 3.0}  // Frenado final: 55→100ms
-};
-
-// TC4: Stress Test - Flujo MUY Alto (~15s)
-PulsePhase test4_phases[] = {
-  {PHASE_TRANSITION, 65.0, 23.0, 8, 3.0},   // Aceleración rápida: 65→23ms
-  {PHASE_STABLE, 23.0, 23.0, 543, 4.0},     // Flujo altísimo: 23ms, 543 pulsos (~12.5s)
-  {PHASE_TRANSITION, 23.0, 80.0, 15, 3.0}   // Frenado: 23→80ms
-};
-
-// TC5: Pulsos Aislados - Fugas (~13s)
-PulsePhase test5_phases[] = {
-  {PHASE_STABLE, 2550.0, 2550.0, 4, 0},     // 4 pulsos separados 2.55s
-  {PHASE_STABLE, 3050.0, 3050.0, 1, 0}      // Último pulso con pausa mayor
-};
-
-// Funciones auxiliares
-float aplicarJitter(float tempo, float jitter_percent, unsigned long pulse_number) {
-  if (jitter_percent <= 0.0) return tempo;
-  
-  unsigned long random_val = (pulse_number * 1103515245 + 12345) & 0x7FFFFFFF;
-  float factor = ((random_val % 2000) / 1000.0) - 1.0;
-  float variation = tempo * (jitter_percent / 100.0) * factor;
-  return tempo + variation;
-}
-
-PulsePhase* getTestPhases(TestCase tc, int* phase_count) {
-  switch (tc) {
-    case TEST_CASE_1:
-      *phase_count = sizeof(test1_phases) / sizeof(PulsePhase);
-      return test1_phases;
-    case TEST_CASE_2:
-      *phase_count = sizeof(test2_phases) / sizeof(PulsePhase);
-      return test2_phases;
-    case TEST_CASE_3:
-      *phase_count = sizeof(test3_phases) / sizeof(PulsePhase);
-      return test3_phases;
-    case TEST_CASE_4:
-      *phase_count = sizeof(test4_phases) / sizeof(PulsePhase);
-      return test4_phases;
-    case TEST_CASE_5:
-      *phase_count = sizeof(test5_phases) / sizeof(PulsePhase);
-      return test5_phases;
-    default:
-      *phase_count = 0;
-      return nullptr;
-  }
-}
+// Lector del fichero de patrón en reproducción (doble buffer)
+static PatternFileReader file_reader;
 
 void inicializarGenerador() {
   generating_pulse = false;
@@ -122,38 +61,204 @@ void inicializarGenerador() {
   Serial.println();
   Serial.println("  5: Single Pulse - Fugas/Pulsos Aislados (~7s)");
   Serial.println("     5 pulsos INDIVIDUALES con timeout de 1s entre ellos");
+  Serial.println();
+  Serial.println("  9: Escenario Completo - Uso doméstico (~271s, ~6350 pulsos)");
+  Serial.println("     60s @ 43.5Hz → pausa 5s → 182s @ 20Hz → pausa 12s → microfuga");
+  Serial.println("     [Generado bajo demanda, sin límite de pulsos]");
   Serial.println("\nUsar botones para cambiar test case en modo WRITE");
   
-  preGenerarPatron(current_test);
-  
-  for (int i = 0; i < pulse_pattern.freq_count && i < GRAPH_WIDTH; i++) {
-    graph_data[i] = pulse_pattern.frequencies[i];
+  cargarPatron(current_test);
+}
+
+static void imprimirResumenPatron() {
+  Serial.print(pulse_pattern.count);
+  Serial.print(" pulsos, ");
+  Serial.print(pulse_pattern.total_ms / 1000.0, 1);
+  Serial.print("s, ");
+  Serial.print(write_preview.width);
+  Serial.print(" columnas de ");
+  Serial.print(write_preview.column_us / 1000.0, 1);
+  Serial.println("ms");
+}
+
+// Canales adicionales: cada uno con su propio patrón (o apagado)
+static void cargarCanalesAdicionales() {
+  for (int ch = 1; ch < WRITE_CHANNEL_COUNT; ch++) {
+    WriteChannel* channel = &write_channels[ch];
+    channel->stream_done = true;
+    if (!channel->enabled) continue;
+    if (!abrirPatron(channel->test, &channel->stream)) {
+      channel->enabled = false;
+      continue;
+    }
+    channel->stream_done = false;
+    Serial.print("  Canal ");
+    Serial.print(ch);
+    Serial.print(" (GPIO");
+    Serial.print(WRITE_CHANNEL_PINS[ch]);
+    Serial.print("): ");
+    Serial.println(TEST_CASE_NAMES[channel->test]);
   }
-  graph_index = pulse_pattern.freq_count;
 }
 
-void preGenerarPatron(TestCase tc) {
-  Serial.println("\n=== PRE-GENERANDO PATRÓN ===");
+void redibujarPantallaWrite(const char* title) {
+  tft.fillScreen(TFT_BLACK);
+  tft.setTextColor(TFT_YELLOW);
+  tft.setTextSize(2);
+  tft.setTextFont(2);
+  tft.setTextDatum(TL_DATUM);
+  tft.drawString(title, 5, 5);
   
-  pulse_pattern.count = 0;
-  pulse_pattern.freq_count = 0;
+  inicializarGrafico();
+  dibujarVistaPrevia(&write_preview);
   
-  int phase_count = 0;
-  PulsePhase* phases = getTestPhases(tc, &phase_count);
+  // Mostrar modo DESPUÉS de dibujar todo (voltaje desactivado en WRITE)
+  mostrarModo();
+}
+
+void cargarPatron(TestCase tc) {
+  WriteChannel* main_channel = &write_channels[0];
+  pattern_from_file = false;
+  cerrarPatronArchivo();
+  main_channel->enabled = true;
+  main_channel->test = tc;
+  main_channel->stream_done = false;
   
-  if (!phases) {
+  if (!abrirPatron(tc, &main_channel->stream)) {
     Serial.println("ERROR: Test case inválido");
+    pattern_ready = false;
     return;
   }
   
-  unsigned long total_time_ms = 0;
+  // Vista previa: una pasada por el stream, sea tabla o fases
+  patternPreviewConstruir(&main_channel->stream, &write_preview);
+  
+  if (main_channel->stream.source == PATTERN_SOURCE_TABLE) {
+    // Tabla generada en compilación: seleccionar el test case es inmediato
+    pulse_pattern = main_channel->stream.table;
+    Serial.print("✓ Patrón cargado (flash): ");
+  } else {
+    pulse_pattern.data = nullptr;
+    pulse_pattern.data_size = 0;
+    pulse_pattern.count = write_preview.pulse_count;
+    pulse_pattern.total_ms = write_preview.total_ms;
+    Serial.print("✓ Patrón en streaming: ");
+  }
+  
+  imprimirResumenPatron();
+  cargarCanalesAdicionales();
+  
+  pattern_ready = true;
+  current_pulse_index = 0;
+}
+
+// Carga un fichero de LittleFS en el canal 0. Se valida entero (CRC, datos y
+// vista previa) antes de tocar el patrón activo; la reproducción lo lee por bloques
+bool cargarPatronArchivo(const char* name) {
+  pulseOutputDetener();
+  generating_pulse = false;
+  
+  PatternFileInfo info;
+  PatternFileError error = abrirPatronArchivo(name, &file_reader, &info);
+  if (error != PATTERN_FILE_OK) {
+    Serial.print("ERROR cargando ");
+    Serial.print(name);
+    Serial.print(": ");
+    Serial.println(patternFileNombreError(error));
+    // El lector puede ser el del patrón activo: volver al test case desde el principio
+    cargarPatron(current_test);
+    return false;
+  }
+  
+  WriteChannel* main_channel = &write_channels[0];
+  main_channel->enabled = true;
+  main_channel->stream_done = false;
+  patternStreamDesdeArchivo(&main_channel->stream, &file_reader);
+  // La vista previa recorre el mismo lector: volver al principio después
+  patternPreviewConstruir(&main_channel->stream, &write_preview);
+  patternStreamReiniciar(&main_channel->stream);
+  
+  pulse_pattern.data = nullptr;
+  pulse_pattern.data_size = 0;
+  pulse_pattern.count = info.pulse_count;
+  pulse_pattern.total_ms = info.total_ms;
+  
+  pattern_from_file = true;
+  strncpy(pattern_file_name, name, sizeof(pattern_file_name) - 1);
+  pattern_file_name[sizeof(pattern_file_name) - 1] = '\0';
+  
+  Serial.print("✓ Patrón desde fichero ");
+  Serial.print(pattern_file_name);
+  Serial.print(info.kind == PATTERN_FILE_PHASES ? " (fases): " : " (períodos): ");
+  imprimirResumenPatron();
+  cargarCanalesAdicionales();
+  
+  pattern_ready = true;
+  current_pulse_index = 0;
+  
+  if (current_mode == MODE_WRITE) {
+    redibujarPantallaWrite(pattern_file_name);
+  }
+  return true;
+}
+
+void reiniciarReproduccionWrite() {
+  pulseOutputDetener();
+  generating_pulse = false;
+  if (pattern_from_file) {
+    char name[sizeof(pattern_file_name)];
+    strcpy(name, pattern_file_name);
+    cargarPatronArchivo(name);
+  } else {
+    cargarPatron(current_test);
+  }
+}
+
+// Cambia el patrón de un canal adicional; en modo WRITE reinicia la reproducción
+// para que todos los canales vuelvan a salir con el mismo origen de tiempo
+bool configurarCanalWrite(int ch, bool enabled, TestCase tc) {
+  if (ch < 1 || ch >= WRITE_CHANNEL_COUNT) return false;
+  
+  write_channels[ch].enabled = enabled;
+  write_channels[ch].test = tc;
+  
+  if (current_mode == MODE_WRITE) {
+    reiniciarReproduccionWrite();
+  }
+  return true;
+}
+
+void mostrarCanalesWrite() {
+  for (int ch = 0; ch < WRITE_CHANNEL_COUNT; ch++) {
+    Serial.printf("Canal %d (GPIO%d): %s\n", ch, WRITE_CHANNEL_PINS[ch],
+                  write_channels[ch].enabled ? TEST_CASE_NAMES[write_channels[ch].test] : "apagado");
+  }
+  pulseOutputImprimirCanales();
+}
+
+static bool todosLosFlujosTerminados() {
+  for (int ch = 0; ch < WRITE_CHANNEL_COUNT; ch++) {
+    if (!write_channels[ch].stream_done) return false;
+  }
+  return true;
+}
+
+// Generador runtime original: solo se usa como referencia para verificar las tablas
+void preGenerarPatron(TestCase tc, PulsePattern* out) {
+  out->count = 0;
+  
+  int phase_count = 0;
+  const PulsePhase* phases = getTestPhases(tc, &phase_count);
+  
+  if (!phases) return;
+  
   int global_pulse_num = 0;
   
   // Generar pulsos fase por fase
-  for (int p = 0; p < phase_count && pulse_pattern.count < MAX_PULSES; p++) {
-    PulsePhase* phase = &phases[p];
+  for (int p = 0; p < phase_count && out->count < MAX_PULSES; p++) {
+    const PulsePhase* phase = &phases[p];
     
-    for (int i = 0; i < phase->num_pulses && pulse_pattern.count < MAX_PULSES; i++) {
+    for (int i = 0; i < phase->num_pulses && out->count < MAX_PULSES; i++) {
       float progress = (phase->num_pulses > 1) ? (float)i / (float)(phase->num_pulses - 1) : 0.0;
       float tempo;
       
@@ -168,118 +273,222 @@ void preGenerarPatron(TestCase tc) {
       // Aplicar jitter
       tempo = aplicarJitter(tempo, phase->jitter_percent, global_pulse_num);
       
-      pulse_pattern.periods[pulse_pattern.count] = tempo;
-      pulse_pattern.count++;
+      out->periods[out->count] = tempo;
+      out->count++;
       global_pulse_num++;
-      total_time_ms += (unsigned long)tempo;
     }
   }
+}
+
+// Compara las tablas de flash con el generador runtime: los µs decodificados
+// deben coincidir exactamente con los que reproduciría el generador float
+bool verificarTablasPatron() {
+  PulsePattern* reference = new PulsePattern;  // Temporal: solo mientras dura la verificación
+  bool all_ok = true;
   
-  unsigned long total_duration_ms = total_time_ms;
+  Serial.println("=== VERIFICACIÓN TABLAS DE PATRÓN ===");
+  for (int tc = TEST_CASE_1; tc <= TEST_CASE_5; tc++) {
+    preGenerarPatron((TestCase)tc, reference);
+    PatternTable table = obtenerTablaPatron((TestCase)tc);
+    
+    PeriodDecoder decoder;
+    periodDecoderIniciar(&decoder, table.data, table.data_size);
+    int mismatches = 0;
+    uint32_t period_us;
+    for (int i = 0; i < reference->count; i++) {
+      if (!periodDecoderSiguiente(&decoder, &period_us) ||
+          period_us != (uint32_t)(reference->periods[i] * 1000.0)) {
+        mismatches++;
+      }
+    }
+    bool ok = (table.count == reference->count) && mismatches == 0 && decoder.pos == decoder.size;
+    
+    Serial.print(TEST_CASE_NAMES[tc]);
+    Serial.println(ok ? ": OK" : ": DIFERENTE");
+    all_ok = all_ok && ok;
+  }
   
-  pulse_pattern.freq_count = 0;
-  unsigned long sample_interval = PULSE_CALC_INTERVAL_MS;
-  int pulse_idx = 0;
-  unsigned long cumulative_time = 0;
+  delete reference;
+  return all_ok;
+}
+
+// Coste y tamaño del formato compacto frente al array float original
+void benchmarkCodecPatrones() {
+  PulsePattern* reference = new PulsePattern;
+  uint32_t* periods_us = new uint32_t[MAX_PULSES];
+  uint8_t* encoded = new uint8_t[MAX_PULSES * 5];
   
-  for (int x = 0; x < GRAPH_WIDTH; x++) {
-    unsigned long sample_time = x * sample_interval;
+  Serial.println("=== BENCHMARK CODEC DE PATRONES ===");
+  Serial.println("TC      pulsos  float(B)  compacto(B)  ratio  lectura float  decod.  cod. (ciclos/periodo)");
+  for (int tc = TEST_CASE_1; tc <= TEST_CASE_5; tc++) {
+    preGenerarPatron((TestCase)tc, reference);
+    PatternTable table = obtenerTablaPatron((TestCase)tc);
+    int count = table.count;
+    if (count == 0) continue;
     
-    if (sample_time >= total_duration_ms) {
-      pulse_pattern.frequencies[pulse_pattern.freq_count] = 0;
-      pulse_pattern.freq_count++;
-      continue;
+    // Referencia: recorrer el array float y convertir a µs como hacía el generador
+    volatile uint32_t sink = 0;
+    uint32_t t0 = ESP.getCycleCount();
+    for (int i = 0; i < count; i++) {
+      sink += (uint32_t)(reference->periods[i] * 1000.0);
     }
+    uint32_t float_cycles = ESP.getCycleCount() - t0;
     
-    while (pulse_idx < pulse_pattern.count && cumulative_time + (unsigned long)pulse_pattern.periods[pulse_idx] <= sample_time) {
-      cumulative_time += (unsigned long)pulse_pattern.periods[pulse_idx];
-      pulse_idx++;
+    PeriodDecoder decoder;
+    periodDecoderIniciar(&decoder, table.data, table.data_size);
+    t0 = ESP.getCycleCount();
+    for (int i = 0; i < count; i++) {
+      periodDecoderSiguiente(&decoder, &periods_us[i]);
     }
+    uint32_t decode_cycles = ESP.getCycleCount() - t0;
     
-    float freq = 0;
-    if (pulse_idx < pulse_pattern.count && pulse_pattern.periods[pulse_idx] > 0) {
-      freq = 1000.0 / pulse_pattern.periods[pulse_idx];
-    }
+    t0 = ESP.getCycleCount();
+    uint32_t encoded_size = codificarPeriodos(periods_us, count, encoded, MAX_PULSES * 5);
+    uint32_t encode_cycles = ESP.getCycleCount() - t0;
+    (void)sink;
     
-    pulse_pattern.frequencies[pulse_pattern.freq_count] = freq;
-    pulse_pattern.freq_count++;
+    Serial.printf("TC%-5d %6d  %8d  %11lu  %5.2f  %13lu  %6lu  %5lu\n",
+                  tc + 1, count, count * (int)sizeof(float), (unsigned long)encoded_size,
+                  (float)(count * sizeof(float)) / encoded_size,
+                  (unsigned long)(float_cycles / count), (unsigned long)(decode_cycles / count),
+                  (unsigned long)(encode_cycles / count));
   }
   
-  Serial.print("✓ Patrón generado: ");
-  Serial.print(pulse_pattern.count);
-  Serial.print(" pulsos, ");
-  Serial.print(total_duration_ms / 1000.0, 1);
-  Serial.print("s, ");
-  Serial.print(pulse_pattern.freq_count);
-  Serial.println(" puntos gráfico");
+  delete[] encoded;
+  delete[] periods_us;
+  delete reference;
+}
+
+// Sintetizador en punto fijo frente al cálculo float con pow() del generador
+// original, sobre las fases de cada test case (sin límite de MAX_PULSES)
+void benchmarkSintetizador() {
+  const int chunk = 256;
+  uint32_t* periods_us = new uint32_t[chunk];
+  uint32_t cpu_mhz = ESP.getCpuFreqMHz();
   
-  pattern_ready = true;
-  current_pulse_index = 0;
+  Serial.println("=== BENCHMARK SINTETIZADOR DE PERIODOS ===");
+  Serial.println("TC      pulsos  float+pow (per/ms)  punto fijo (per/ms)  speedup  dif. base max (us)");
+  for (int tc = 0; tc < NUM_TEST_CASES; tc++) {
+    int phase_count = 0;
+    const PulsePhase* phases = getTestPhases((TestCase)tc, &phase_count);
+    if (!phases) continue;
+    
+    // Referencia: el bucle de preGenerarPatron (pow en double + LCG)
+    volatile uint32_t sink = 0;
+    int count = 0;
+    uint32_t t0 = ESP.getCycleCount();
+    for (int p = 0; p < phase_count; p++) {
+      const PulsePhase* phase = &phases[p];
+      for (int i = 0; i < phase->num_pulses; i++) {
+        float progress = (phase->num_pulses > 1) ? (float)i / (float)(phase->num_pulses - 1) : 0.0;
+        float tempo = phase->tempo_start_ms;
+        if (phase->type == PHASE_TRANSITION) {
+          float eased_progress = (progress == 1.0) ? 1.0 : 1.0 - pow(2.0, -10.0 * progress);
+          tempo = phase->tempo_start_ms + (phase->tempo_end_ms - phase->tempo_start_ms) * eased_progress;
+        }
+        sink += (uint32_t)(aplicarJitter(tempo, phase->jitter_percent, count) * 1000.0);
+        count++;
+      }
+    }
+    uint32_t float_cycles = ESP.getCycleCount() - t0;
+    
+    // Sintetizador, por bloques como lo consume el stream
+    PhaseSynth synth;
+    int generated = 0;
+    t0 = ESP.getCycleCount();
+    for (int p = 0; p < phase_count; p++) {
+      patternSynthIniciarFase(&synth, phases[p]);
+      for (int i = 0; i < phases[p].num_pulses; i++) {
+        periods_us[generated % chunk] = patternSynthPeriodo(&synth, i, (uint32_t)generated);
+        generated++;
+      }
+    }
+    uint32_t synth_cycles = ESP.getCycleCount() - t0;
+    (void)sink;
+    
+    // Precisión del easing (sin jitter) frente al generador float
+    uint32_t max_diff_us = 0;
+    for (int p = 0; p < phase_count; p++) {
+      patternSynthIniciarFase(&synth, phases[p]);
+      for (int i = 0; i < phases[p].num_pulses; i++) {
+        int32_t diff = (int32_t)patternSynthBase(&synth, i) - (int32_t)(uint32_t)(calcularTempoFase(phases[p], i) * 1000.0);
+        uint32_t abs_diff = (diff < 0) ? (uint32_t)(-diff) : (uint32_t)diff;
+        if (abs_diff > max_diff_us) max_diff_us = abs_diff;
+      }
+    }
+    
+    if (count == 0 || float_cycles == 0 || synth_cycles == 0) continue;
+    float float_rate = (float)count * cpu_mhz * 1000.0f / float_cycles;
+    float synth_rate = (float)count * cpu_mhz * 1000.0f / synth_cycles;
+    Serial.printf("%-7s %6d  %18.1f  %19.1f  %6.1fx  %18lu\n", TEST_CASE_NAMES[tc], count, float_rate,
+                  synth_rate, synth_rate / float_rate, (unsigned long)max_diff_us);
+  }
+  
+  delete[] periods_us;
 }
 
 void generarPulsos() {
   if (!pattern_ready) return;
-  if (current_pulse_index >= pulse_pattern.count) {
-    if (generating_pulse) {
-      Serial.print("*** PATRÓN COMPLETADO: ");
-      Serial.print(pulse_pattern.count);
-      Serial.println(" pulsos generados ***");
+  if (!generating_pulse && todosLosFlujosTerminados()) return;  // Patrón ya reproducido
+
+  // Alimentar el anillo de cada canal con su stream (un período cada vez, memoria O(1));
+  // el timing de los flancos lo lleva el timer hardware
+  uint32_t period_us;
+  for (int ch = 0; ch < WRITE_CHANNEL_COUNT; ch++) {
+    WriteChannel* channel = &write_channels[ch];
+    while (!channel->stream_done && pulseOutputEspacioLibre(ch) > 0) {
+      if (!patternStreamSiguiente(&channel->stream, &period_us)) {
+        channel->stream_done = true;
+        break;
+      }
+      pulseOutputEncolar(ch, period_us);
+      if (ch == 0) current_pulse_index++;
     }
-    generating_pulse = false;
-    current_gen_frequency = 0.0;
-    digitalWrite(SENSOR_PIN, LOW);
-    return;
+    // Con el anillo ya lleno, recargar el bloque libre de los ficheros
+    patternStreamRellenar(&channel->stream);
   }
-  
-  unsigned long current_time_us = micros();
-  
-  // Inicializar en el primer pulso
-  if (next_pulse_time_us == 0) {
-    next_pulse_time_us = current_time_us;
-    last_pulse_ts_us = current_time_us;
+
+  if (!generating_pulse) {
+    pulseTelemetryReset();
+    if (loopbackActivo()) {
+      loopbackActivar(true);  // Vacía capturas y estadísticas del autotest
+    }
+    pulseOutputIniciar();
     generating_pulse = true;
   }
-  
-  // Manejar fin del pulso HIGH (no bloqueante)
-  if (pulse_state && current_time_us >= pulse_end_time_us) {
-    digitalWrite(SENSOR_PIN, LOW);
-    pulse_state = false;
+
+  for (int ch = 0; ch < WRITE_CHANNEL_COUNT; ch++) {
+    if (write_channels[ch].stream_done) {
+      pulseOutputCerrarFlujo(ch);
+    }
   }
-  
-  // Generar nuevo pulso
-  if (!pulse_state && current_time_us >= next_pulse_time_us) {
-    long timing_error_us = (long)current_time_us - (long)next_pulse_time_us;
-    
-    // Iniciar pulso HIGH
-    digitalWrite(SENSOR_PIN, HIGH);
-    pulse_state = true;
-    pulse_end_time_us = current_time_us + 5000;  // Termina en 5ms
-    
-    // Leer el período del array en ms (YA tiene el jitter aplicado)
-    pulse_interval = pulse_pattern.periods[current_pulse_index];
-    unsigned long pulse_interval_us = (unsigned long)(pulse_interval * 1000.0);
-    
-    unsigned long real_period_us = (last_pulse_ts_us > 0) ? (current_time_us - last_pulse_ts_us) : 0;
-    
-    // LOG del pulso generado
-    Serial.print("[GEN] Pulse #");
-    Serial.print(current_pulse_index + 1);
-    Serial.print(": ts=");
-    Serial.print(current_time_us / 1000);
-    Serial.print("ms, period=");
-    Serial.print(real_period_us / 1000.0, 1);
-    Serial.print("ms, planned=");
-    Serial.print(pulse_interval, 1);
-    Serial.print("ms, err=");
-    Serial.print(timing_error_us / 1000.0, 1);
-    Serial.println("ms");
-    
-    last_pulse_ts_us = current_time_us;
-    current_pulse_index++;
-    current_gen_frequency = 1000.0 / pulse_interval;
-    
-    // Programar próximo pulso (basado en el tiempo ACTUAL, sin efecto del delay)
-    next_pulse_time_us = current_time_us + pulse_interval_us;
+
+  // Frecuencia actual (canal 0) para la UI; el detalle por pulso queda en la telemetría
+  uint32_t current_period_us = pulse_output_stats[0].current_period_us;
+  if (current_period_us > 0) {
+    pulse_interval = current_period_us / 1000.0;
+    current_gen_frequency = 1000000.0 / current_period_us;
+  }
+
+  if (loopbackActivo()) {
+    loopbackProcesar((uint32_t)pulseOutputAhoraUs());
+  }
+
+  if (pulseOutputTerminado()) {
+    Serial.print("*** PATRÓN COMPLETADO: ");
+    Serial.print(pulse_output_stats[0].emitted);
+    Serial.print(" pulsos generados, underruns=");
+    Serial.print(pulse_output_stats[0].underruns);
+    Serial.println(" ***");
+    pulseTelemetryImprimirResumen();
+    pulseOutputImprimirCanales();
+    if (loopbackActivo()) {
+      loopbackFinalizar((uint32_t)pulseOutputAhoraUs());
+      loopbackImprimirInforme();
+    }
+    Serial.println("Comando 'dump' para volcar la telemetría por pulso");
+    generating_pulse = false;
+    current_gen_frequency = 0.0;
   }
 }
 
@@ -288,36 +497,20 @@ void manejarModoWrite() {
 }
 
 void manejarBotonIzquierdoWrite() {
-  current_test = (TestCase)((current_test + 1) % 5);
+  current_test = (TestCase)((current_test + 1) % NUM_TEST_CASES);
+  
+  pulseOutputDetener();  // Vacía los anillos y deja los pines LOW
   
   generating_pulse = false;
   next_pulse_time = 0;
-  next_pulse_time_us = 0;
-  last_pulse_ts_us = 0;
-  pulse_end_time_us = 0;
   pulse_state = false;
   pattern_ready = false;
   current_pulse_index = 0;
   test_start_time = millis();
   
-  digitalWrite(SENSOR_PIN, LOW);  // Asegurar que el pin esté LOW
-  
   Serial.println("Cambiando a: " + String(TEST_CASE_NAMES[current_test]));
   
-  preGenerarPatron(current_test);
+  cargarPatron(current_test);
   
-  tft.fillScreen(TFT_BLACK);
-  tft.setTextColor(TFT_YELLOW);
-  tft.setTextSize(2);
-  tft.setTextFont(2);
-  tft.setTextDatum(TL_DATUM);
-  tft.drawString(TEST_CASE_NAMES[current_test], 5, 5);
-  
-  inicializarGrafico();
-  for (int i = 0; i < pulse_pattern.freq_count && i < GRAPH_WIDTH; i++) {
-    actualizarGrafico(pulse_pattern.frequencies[i]);
-  }
-  
-  // Mostrar modo DESPUÉS de dibujar todo (voltaje desactivado en WRITE)
-  mostrarModo();
+  redibujarPantallaWrite(TEST_CASE_NAMES[current_test]);
 }
@@ -0,0 +1,212 @@
+#include "pattern_checker.h"
+
+// |a - ref| <= ref * percent / 100
+static bool dentroDeMargen(uint64_t value_us, uint64_t ref_us) {
+  uint64_t diff = (value_us > ref_us) ? value_us - ref_us : ref_us - value_us;
+  return diff * 100 <= ref_us * CHECK_TOLERANCE_PERCENT;
+}
+
+static int indiceEstadistica(int phase) {
+  return (phase < CHECK_MAX_PHASES) ? phase : CHECK_MAX_PHASES - 1;
+}
+
+// Lee períodos de la referencia hasta tener e[k] y e[k+1] (si existen)
+static void rellenarVentana(PatternChecker* checker) {
+  uint32_t period_us;
+  while (checker->window_count < 2 && checker->pulled < checker->expected_periods &&
+         patternStreamSiguiente(&checker->stream, &period_us)) {
+    // Fase del período: saltar las agotadas (o vacías)
+    if (checker->phases) {
+      while (checker->pulled >= checker->stream_phase_end && checker->stream_phase + 1 < checker->phase_count) {
+        checker->stream_phase++;
+        checker->stream_phase_end += (uint32_t)checker->phases[checker->stream_phase].num_pulses;
+      }
+    }
+    checker->window_us[checker->window_count] = period_us;
+    checker->window_phase[checker->window_count] = (uint8_t)indiceEstadistica(checker->stream_phase);
+    checker->window_count++;
+    checker->pulled++;
+  }
+}
+
+// Descarta los n primeros períodos de la ventana
+static void avanzarVentana(PatternChecker* checker, int n) {
+  if (n >= checker->window_count) {
+    checker->window_count = 0;
+  } else {
+    checker->window_us[0] = checker->window_us[1];
+    checker->window_phase[0] = checker->window_phase[1];
+    checker->window_count = 1;
+  }
+  checker->consumed += n;
+  rellenarVentana(checker);
+}
+
+static void registrarError(CheckPhaseStats* stats, uint64_t captured_us, uint64_t expected_us) {
+  int64_t error_us = (int64_t)captured_us - (int64_t)expected_us;
+  uint64_t abs_error_us = (error_us < 0) ? (uint64_t)-error_us : (uint64_t)error_us;
+  uint32_t permille = (expected_us > 0) ? (uint32_t)(abs_error_us * 1000 / expected_us) : 0;
+  stats->error_sum_us += error_us;
+  stats->expected_sum_us += expected_us;
+  if (permille > stats->max_error_permille) stats->max_error_permille = permille;
+}
+
+void verificadorTotales(const PatternStream* stream, uint32_t* pulses, uint32_t* periods, uint64_t* duration_us) {
+  PatternStream cursor = *stream;
+  patternStreamReiniciar(&cursor);
+
+  uint32_t count = 0;
+  uint64_t total_us = 0;
+  uint32_t last_us = 0;
+  uint32_t period_us;
+  while (patternStreamSiguiente(&cursor, &period_us)) {
+    total_us += period_us;
+    last_us = period_us;
+    count++;
+  }
+  *pulses = count;
+  *periods = (count > 0) ? count - 1 : 0;
+  // Del primer al último flanco: el período que sigue al último pulso no se ve
+  *duration_us = total_us - last_us;
+}
+
+void verificadorIniciar(PatternChecker* checker, const PatternStream* stream,
+                        const PulsePhase* phases, int phase_count) {
+  uint32_t pulses;
+  verificadorTotales(stream, &pulses, &checker->expected_periods, &checker->expected_us);
+
+  checker->stream = *stream;
+  patternStreamReiniciar(&checker->stream);
+  checker->phases = (phases && phase_count > 0) ? phases : nullptr;
+  checker->phase_count = checker->phases ? phase_count : 1;
+  checker->stats_count = indiceEstadistica(checker->phase_count - 1) + 1;
+
+  for (int i = 0; i < CHECK_MAX_PHASES; i++) {
+    CheckPhaseStats* stats = &checker->stats[i];
+    stats->expected = 0;
+    stats->matched = 0;
+    stats->missed = 0;
+    stats->extra = 0;
+    stats->mismatched = 0;
+    stats->error_sum_us = 0;
+    stats->expected_sum_us = 0;
+    stats->max_error_permille = 0;
+  }
+
+  // Períodos medibles por fase: el último pulso del patrón no cierra período
+  if (checker->phases) {
+    uint32_t start = 0;
+    for (int p = 0; p < phase_count; p++) {
+      uint32_t end = start + (uint32_t)phases[p].num_pulses;
+      uint32_t measurable_end = (end < checker->expected_periods) ? end : checker->expected_periods;
+      if (measurable_end > start) {
+        checker->stats[indiceEstadistica(p)].expected += measurable_end - start;
+      }
+      start = end;
+    }
+  } else {
+    checker->stats[0].expected = checker->expected_periods;
+  }
+
+  checker->window_count = 0;
+  checker->pulled = 0;
+  checker->stream_phase = 0;
+  checker->stream_phase_end = checker->phases ? (uint32_t)phases[0].num_pulses : checker->expected_periods;
+  checker->pending_us = 0;
+  checker->pending_pieces = 0;
+  checker->consumed = 0;
+  checker->captured = 0;
+  checker->missed = 0;
+  checker->extra = 0;
+  checker->mismatched = 0;
+  checker->trailing = 0;
+  checker->lost_sync = false;
+  rellenarVentana(checker);
+}
+
+void verificadorPeriodo(PatternChecker* checker, uint32_t period_us) {
+  checker->captured++;
+  if (checker->window_count == 0) {
+    checker->trailing++;
+    return;
+  }
+
+  uint64_t total_us = (uint64_t)checker->pending_us + period_us;
+  int pieces = checker->pending_pieces + 1;
+  uint32_t expected_us = checker->window_us[0];
+  CheckPhaseStats* stats = &checker->stats[checker->window_phase[0]];
+
+  if (dentroDeMargen(total_us, expected_us)) {
+    // Coincide (entero o sumando los trozos de un pulso de más)
+    registrarError(stats, total_us, expected_us);
+    stats->matched++;
+    stats->extra += pieces - 1;
+    checker->extra += pieces - 1;
+    avanzarVentana(checker, 1);
+  } else if (total_us * 100 < (uint64_t)expected_us * (100 - CHECK_TOLERANCE_PERCENT) &&
+             pieces < CHECK_MAX_SPLIT) {
+    // Demasiado corto: esperar al siguiente trozo
+    checker->pending_us = (uint32_t)total_us;
+    checker->pending_pieces = pieces;
+    return;
+  } else if (checker->window_count == 2 &&
+             dentroDeMargen(total_us, (uint64_t)expected_us + checker->window_us[1])) {
+    // Falta el pulso entre e[k] y e[k+1]: se cuenta en la fase de e[k+1]
+    CheckPhaseStats* next = &checker->stats[checker->window_phase[1]];
+    registrarError(stats, total_us, (uint64_t)expected_us + checker->window_us[1]);
+    stats->matched++;
+    next->matched++;
+    next->missed++;
+    checker->missed++;
+    avanzarVentana(checker, 2);
+  } else {
+    stats->matched++;
+    stats->mismatched++;
+    checker->mismatched++;
+    avanzarVentana(checker, 1);
+  }
+  checker->pending_us = 0;
+  checker->pending_pieces = 0;
+}
+
+void verificadorDiscontinuidad(PatternChecker* checker) {
+  if (checker->captured > 0 && checker->window_count > 0) {
+    checker->lost_sync = true;
+  }
+}
+
+float verificadorSesgoPorciento(const CheckPhaseStats* stats) {
+  if (stats->expected_sum_us == 0) return 0.0f;
+  return (float)((double)stats->error_sum_us * 100.0 / (double)stats->expected_sum_us);
+}
+
+bool verificadorFaseConforme(const CheckPhaseStats* stats) {
+  int64_t abs_sum_us = (stats->error_sum_us < 0) ? -stats->error_sum_us : stats->error_sum_us;
+  return stats->mismatched == 0 &&
+         (uint64_t)abs_sum_us * 1000 <= stats->expected_sum_us * CHECK_MAX_BIAS_PERMILLE;
+}
+
+CheckVerdict verificadorVeredicto(const PatternChecker* checker) {
+  if (checker->captured == 0) return CHECK_WAITING;
+
+  bool conforming = !checker->lost_sync && checker->missed + checker->extra <= CHECK_MAX_SLIPS;
+  for (int p = 0; p < checker->stats_count && conforming; p++) {
+    conforming = verificadorFaseConforme(&checker->stats[p]);
+  }
+
+  if (checker->consumed >= checker->expected_periods) {
+    return conforming ? CHECK_PASS : CHECK_FAIL;
+  }
+  return conforming ? CHECK_RUNNING : CHECK_FAILING;
+}
+
+const char* verificadorNombreVeredicto(CheckVerdict verdict) {
+  switch (verdict) {
+    case CHECK_WAITING: return "ESPERA";
+    case CHECK_RUNNING: return "OK";
+    case CHECK_FAILING: return "FALLO";
+    case CHECK_PASS: return "PASS";
+    case CHECK_FAIL: return "FAIL";
+  }
+  return "?";
+}
@@ -0,0 +1,14 @@
+#include "pattern_codec.h"
+
+uint32_t codificarPeriodos(const uint32_t* periods_us, int count, uint8_t* out, uint32_t capacity) {
+  uint32_t pos = 0;
+  uint32_t previous_us = 0;
+
+  for (int i = 0; i < count; i++) {
+    uint32_t zz = zigzagCodificar((int32_t)(periods_us[i] - previous_us));
+    if (pos + varintLongitud(zz) > capacity) return 0;
+    pos += varintEscribir(out + pos, zz);
+    previous_us = periods_us[i];
+  }
+  return pos;
+}
@@ -0,0 +1,266 @@
+#include "pattern_file.h"
+#include <string.h>
+#include <math.h>
+
+static uint32_t leerU32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static float leerF32(const uint8_t* p) {
+  uint32_t bits = leerU32(p);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+uint32_t patternFileCrc32(uint32_t crc, const uint8_t* data, uint32_t length) {
+  // CRC-32 IEEE bit a bit: sin tabla, el coste va en la validación, no en la reproducción
+  crc = ~crc;
+  for (uint32_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+const char* patternFileNombreError(PatternFileError error) {
+  switch (error) {
+    case PATTERN_FILE_OK: return "OK";
+    case PATTERN_FILE_ERR_READ: return "error de lectura / truncado";
+    case PATTERN_FILE_ERR_MAGIC: return "no es un fichero de patrón";
+    case PATTERN_FILE_ERR_VERSION: return "versión no soportada";
+    case PATTERN_FILE_ERR_KIND: return "tipo desconocido";
+    case PATTERN_FILE_ERR_SIZE: return "tamaño incoherente";
+    case PATTERN_FILE_ERR_CRC: return "CRC incorrecto";
+    case PATTERN_FILE_ERR_DATA: return "datos inválidos";
+  }
+  return "?";
+}
+
+// Lee el siguiente bloque del payload en el buffer indicado
+static void cargarBuffer(PatternFileReader* reader, int index) {
+  uint32_t remaining = reader->header.payload_size - reader->payload_loaded;
+  int length = (remaining < PATTERN_FILE_CHUNK_SIZE) ? (int)remaining : PATTERN_FILE_CHUNK_SIZE;
+  int got = 0;
+
+  if (length > 0) {
+    got = reader->io.leer(reader->io.ctx, reader->buffers[index], length);
+    if (got < 0) got = 0;
+    if (got != length) reader->error = PATTERN_FILE_ERR_READ;
+    reader->crc32 = patternFileCrc32(reader->crc32, reader->buffers[index], got);
+    reader->payload_loaded += got;
+  }
+  reader->buffer_length[index] = got;
+  reader->buffer_loaded[index] = true;
+}
+
+static bool leerByte(PatternFileReader* reader, uint8_t* byte) {
+  if (reader->pos >= reader->buffer_length[reader->active]) {
+    if (reader->buffer_length[reader->active] == 0) return false;  // Fin del payload
+
+    // Bloque agotado: pasar al otro y dejar este pendiente de recarga
+    reader->buffer_loaded[reader->active] = false;
+    reader->active ^= 1;
+    reader->pos = 0;
+    if (!reader->buffer_loaded[reader->active]) {
+      reader->stalls++;
+      cargarBuffer(reader, reader->active);
+    }
+    if (reader->buffer_length[reader->active] == 0) return false;
+  }
+  *byte = reader->buffers[reader->active][reader->pos++];
+  return true;
+}
+
+PatternFileError patternFileAbrir(PatternFileReader* reader, const PatternFileIo& io) {
+  uint8_t header[PATTERN_FILE_HEADER_SIZE];
+
+  reader->io = io;
+  reader->error = PATTERN_FILE_OK;
+
+  if (!io.rebobinar(io.ctx, 0) || io.leer(io.ctx, header, PATTERN_FILE_HEADER_SIZE) != PATTERN_FILE_HEADER_SIZE) {
+    return reader->error = PATTERN_FILE_ERR_READ;
+  }
+  if (memcmp(header, PATTERN_FILE_MAGIC, 4) != 0) return reader->error = PATTERN_FILE_ERR_MAGIC;
+
+  reader->header.version = header[4];
+  reader->header.kind = header[5];
+  reader->header.count = leerU32(header + 8);
+  reader->header.payload_size = leerU32(header + 12);
+  reader->header.crc32 = leerU32(header + 16);
+
+  if (reader->header.version != PATTERN_FILE_VERSION) return reader->error = PATTERN_FILE_ERR_VERSION;
+
+  if (reader->header.kind == PATTERN_FILE_PERIODS) {
+    // Cada período ocupa entre 1 y 5 bytes
+    if (reader->header.payload_size < reader->header.count ||
+        reader->header.payload_size > (uint64_t)reader->header.count * 5) {
+      return reader->error = PATTERN_FILE_ERR_SIZE;
+    }
+    return PATTERN_FILE_OK;  // El payload se carga al crear el stream
+  }
+
+  if (reader->header.kind != PATTERN_FILE_PHASES) return reader->error = PATTERN_FILE_ERR_KIND;
+
+  if (reader->header.count > PATTERN_FILE_MAX_PHASES ||
+      reader->header.payload_size != reader->header.count * PATTERN_FILE_PHASE_SIZE) {
+    return reader->error = PATTERN_FILE_ERR_SIZE;
+  }
+
+  uint32_t crc = 0;
+  uint64_t total_pulses = 0;
+  for (uint32_t i = 0; i < reader->header.count; i++) {
+    uint8_t record[PATTERN_FILE_PHASE_SIZE];
+    if (io.leer(io.ctx, record, PATTERN_FILE_PHASE_SIZE) != PATTERN_FILE_PHASE_SIZE) {
+      return reader->error = PATTERN_FILE_ERR_READ;
+    }
+    crc = patternFileCrc32(crc, record, PATTERN_FILE_PHASE_SIZE);
+
+    PulsePhase* phase = &reader->phases[i];
+    uint8_t type = record[0] & ~PATTERN_FILE_PHASE_GAUSSIAN;
+    phase->type = (PhaseType)type;
+    phase->jitter_type = (record[0] & PATTERN_FILE_PHASE_GAUSSIAN) ? JITTER_GAUSSIAN : JITTER_UNIFORM;
+    phase->tempo_start_ms = leerF32(record + 1);
+    phase->tempo_end_ms = leerF32(record + 5);
+    uint32_t num_pulses = leerU32(record + 9);
+    phase->jitter_percent = leerF32(record + 13);
+
+    // Sin sintetizar cada período, el tope de pulsos acota lo que cuesta recorrer el fichero
+    total_pulses += num_pulses;
+    if (total_pulses > PATTERN_FILE_MAX_PULSES) return reader->error = PATTERN_FILE_ERR_SIZE;
+    phase->num_pulses = (int)num_pulses;
+
+    // Comparaciones escritas para que NaN también sea inválido. El período
+    // más corto posible (tempo menor menos el jitter máximo: ±1 o ±1.73
+    // veces jitter_percent) tiene que quedar en al menos 1 µs.
+    float jitter_max = phase->jitter_percent * ((phase->jitter_type == JITTER_GAUSSIAN) ? 1.7320508f : 1.0f);
+    float min_us = fminf(phase->tempo_start_ms, phase->tempo_end_ms) * 1000.0f * (1.0f - jitter_max / 100.0f);
+    bool valid = (type == PHASE_TRANSITION || type == PHASE_STABLE) &&
+                 phase->tempo_start_ms * 1000.0f < 4.0e9f && phase->tempo_end_ms * 1000.0f < 4.0e9f &&
+                 phase->jitter_percent >= 0.0f && min_us >= 1.0f;
+    if (!valid) return reader->error = PATTERN_FILE_ERR_DATA;
+  }
+  if (crc != reader->header.crc32) return reader->error = PATTERN_FILE_ERR_CRC;
+
+  return PATTERN_FILE_OK;
+}
+
+bool patternFileReiniciar(PatternFileReader* reader) {
+  if (reader->header.kind != PATTERN_FILE_PERIODS) return true;
+  if (!reader->io.rebobinar(reader->io.ctx, PATTERN_FILE_HEADER_SIZE)) {
+    reader->error = PATTERN_FILE_ERR_READ;
+    return false;
+  }
+  reader->payload_loaded = 0;
+  reader->crc32 = 0;
+  reader->decoded = 0;
+  reader->previous_us = 0;
+  reader->stalls = 0;
+  reader->active = 0;
+  reader->pos = 0;
+  cargarBuffer(reader, 0);
+  cargarBuffer(reader, 1);
+  return reader->error == PATTERN_FILE_OK;
+}
+
+bool patternFileSiguientePeriodo(PatternFileReader* reader, uint32_t* period_us) {
+  if (reader->decoded >= reader->header.count) return false;
+
+  uint32_t value = 0;
+  int shift = 0;
+  uint8_t byte;
+  do {
+    if (shift > 28 || !leerByte(reader, &byte)) {
+      if (reader->error == PATTERN_FILE_OK) reader->error = PATTERN_FILE_ERR_DATA;
+      return false;
+    }
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+
+  reader->previous_us += (uint32_t)zigzagDecodificar(value);
+  reader->decoded++;
+  *period_us = reader->previous_us;
+  return true;
+}
+
+void patternFileRellenar(PatternFileReader* reader) {
+  if (reader->header.kind != PATTERN_FILE_PERIODS) return;
+  int idle = reader->active ^ 1;
+  if (!reader->buffer_loaded[idle]) {
+    cargarBuffer(reader, idle);
+  }
+}
+
+void patternStreamDesdeArchivo(PatternStream* stream, PatternFileReader* reader) {
+  if (reader->header.kind == PATTERN_FILE_PHASES) {
+    patternStreamDesdeFases(stream, reader->phases, (int)reader->header.count);
+    return;
+  }
+  patternStreamDesdeFases(stream, nullptr, 0);
+  stream->source = PATTERN_SOURCE_FILE;
+  stream->file = reader;
+  patternStreamReiniciar(stream);
+}
+
+// Duración sin jitter (el jitter tiene media nula) de una fase, en forma
+// cerrada: la transición va de start a end con easing 1 - 2^(-10p), p =
+// i / (n - 1), y el último pulso es end exacto, así que la suma de easings
+// de los n - 1 primeros es una serie geométrica.
+static double duracionFaseUs(const PulsePhase& phase) {
+  int n = phase.num_pulses;
+  double start_us = (uint32_t)(phase.tempo_start_ms * 1000.0f);   // Truncado, como el sintetizador
+  double end_us = (uint32_t)(phase.tempo_end_ms * 1000.0f);
+  if (n <= 0) return 0.0;
+  if (phase.type == PHASE_STABLE) return n * start_us;
+  if (n == 1) return start_us;
+
+  double r = exp2(-10.0 / (n - 1));
+  double powers = (1.0 - exp2(-10.0)) / (1.0 - r);     // sum r^i, i = 0..n-2
+  double easing_sum = (n - 1) - powers;
+  return (n - 1) * start_us + (end_us - start_us) * easing_sum + end_us;
+}
+
+PatternFileError patternFileValidar(PatternFileReader* reader, const PatternFileIo& io, PatternFileInfo* info) {
+  PatternFileError error = patternFileAbrir(reader, io);
+  if (error != PATTERN_FILE_OK) return error;
+
+  uint32_t count = 0;
+  uint64_t total_us = 0;
+
+  if (reader->header.kind == PATTERN_FILE_PHASES) {
+    // Los registros ya están validados al abrir: pulsos y duración salen de ellos
+    double phases_us = 0.0;
+    for (uint32_t i = 0; i < reader->header.count; i++) {
+      count += (uint32_t)reader->phases[i].num_pulses;
+      phases_us += duracionFaseUs(reader->phases[i]);
+    }
+    total_us = (uint64_t)(phases_us + 0.5);
+  } else {
+    PatternStream stream;
+    patternStreamDesdeArchivo(&stream, reader);
+
+    uint32_t period_us;
+    while (patternStreamSiguiente(&stream, &period_us)) {
+      if (period_us == 0) return reader->error = PATTERN_FILE_ERR_DATA;
+      total_us += period_us;
+      count++;
+    }
+
+    if (reader->error != PATTERN_FILE_OK) return reader->error;
+    // Todo el payload consumido y con el CRC de la cabecera
+    bool consumed = reader->payload_loaded == reader->header.payload_size &&
+                    reader->pos == reader->buffer_length[reader->active] &&
+                    (!reader->buffer_loaded[reader->active ^ 1] || reader->buffer_length[reader->active ^ 1] == 0);
+    if (count != reader->header.count || !consumed) return reader->error = PATTERN_FILE_ERR_SIZE;
+    if (reader->crc32 != reader->header.crc32) return reader->error = PATTERN_FILE_ERR_CRC;
+  }
+
+  info->kind = reader->header.kind;
+  info->pulse_count = (int)count;
+  info->total_ms = (uint32_t)(total_us / 1000);
+  info->payload_size = reader->header.payload_size;
+  return PATTERN_FILE_OK;
+}
@@ -0,0 +1,113 @@
+#include "pattern_preview.h"
+#include <float.h>
+#include <new>
+
+// Eje de tiempo: columnas iguales que cubren todo el patrón
+static void ajustarEje(PatternPreview* preview, uint64_t total_us, int count) {
+  preview->pulse_count = count;
+  preview->total_ms = (uint32_t)(total_us / 1000);
+  preview->column_us = (uint32_t)((total_us + GRAPH_WIDTH - 1) / GRAPH_WIDTH);
+  if (preview->column_us == 0) preview->column_us = 1;
+  preview->width = (int)((total_us + preview->column_us - 1) / preview->column_us);
+
+  for (int x = 0; x < GRAPH_WIDTH; x++) {
+    preview->freq_min[x] = FLT_MAX;
+    preview->freq_max[x] = 0;
+  }
+}
+
+static void agregarPeriodo(PatternPreview* preview, int x, uint32_t period_us) {
+  float freq = (period_us > 0) ? (float)(1000000.0 / period_us) : 0;
+  if (freq < preview->freq_min[x]) preview->freq_min[x] = freq;
+  if (freq > preview->freq_max[x]) preview->freq_max[x] = freq;
+}
+
+static void cerrarColumnas(PatternPreview* preview) {
+  for (int x = 0; x < GRAPH_WIDTH; x++) {
+    if (preview->freq_min[x] == FLT_MAX) preview->freq_min[x] = 0;
+  }
+}
+
+// Primer pulso de [lo, hi) que acaba después de t (hi si no hay ninguno)
+static int primerFinPosterior(const uint32_t* end_us, int lo, int hi, uint32_t t) {
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (end_us[mid] > t) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+void patternPreviewDesdePrefijos(const uint32_t* end_us, int count, PatternPreview* preview) {
+  uint32_t total_us = (count > 0) ? end_us[count - 1] : 0;
+  ajustarEje(preview, total_us, count);
+
+  int first = 0;
+  for (int x = 0; x < preview->width; x++) {
+    // La columna cubre [start, end): pulsos que empiezan antes de end y acaban después de start
+    uint32_t start_us = (uint32_t)x * preview->column_us;
+    uint32_t end_col_us = (total_us - start_us > preview->column_us) ? start_us + preview->column_us : total_us;
+
+    first = primerFinPosterior(end_us, first, count, start_us);
+    int last = primerFinPosterior(end_us, first, count, end_col_us - 1);
+    if (last >= count) last = count - 1;
+
+    for (int i = first; i <= last; i++) {
+      agregarPeriodo(preview, x, end_us[i] - ((i > 0) ? end_us[i - 1] : 0));
+    }
+  }
+  cerrarColumnas(preview);
+}
+
+// Sin memoria para la suma prefija: cada pulso se reparte por las columnas que toca
+static void repartirPulsos(PatternStream* cursor, PatternPreview* preview) {
+  uint64_t start_us = 0;
+  uint32_t period_us;
+
+  while (patternStreamSiguiente(cursor, &period_us)) {
+    uint64_t end_us = start_us + period_us;
+    int first = (int)(start_us / preview->column_us);
+    int last = (period_us > 0) ? (int)((end_us - 1) / preview->column_us) : first;
+    if (last >= preview->width) last = preview->width - 1;
+    for (int x = first; x <= last; x++) {
+      agregarPeriodo(preview, x, period_us);
+    }
+    start_us = end_us;
+  }
+}
+
+void patternPreviewConstruir(const PatternStream* stream, PatternPreview* preview) {
+  PatternStream cursor = *stream;
+  patternStreamReiniciar(&cursor);
+
+  int capacity = patternStreamLongitud(stream);
+  uint32_t* end_us = nullptr;
+  if (capacity > 0 && capacity <= PATTERN_PREVIEW_MAX_PULSES) {
+    end_us = new (std::nothrow) uint32_t[capacity];
+  }
+
+  // Primera pasada: suma prefija (y total, por si hay que repartir)
+  bool prefix_ok = (end_us != nullptr);
+  uint64_t total_us = 0;
+  int count = 0;
+  uint32_t period_us;
+  while (patternStreamSiguiente(&cursor, &period_us)) {
+    total_us += period_us;
+    if (count >= capacity || total_us > UINT32_MAX) prefix_ok = false;
+    if (prefix_ok) end_us[count] = (uint32_t)total_us;
+    count++;
+  }
+
+  if (prefix_ok) {
+    patternPreviewDesdePrefijos(end_us, count, preview);
+  } else {
+    ajustarEje(preview, total_us, count);
+    patternStreamReiniciar(&cursor);
+    repartirPulsos(&cursor, preview);
+    cerrarColumnas(preview);
+  }
+  delete[] end_us;
+}
@@ -0,0 +1,90 @@
+#include "pattern_storage.h"
+#include <LittleFS.h>
+
+static bool storage_ready = false;
+static File pattern_file;  // Fichero en reproducción
+
+static int leerArchivo(void* ctx, uint8_t* buffer, int length) {
+  return (int)((File*)ctx)->read(buffer, length);
+}
+
+static bool rebobinarArchivo(void* ctx, uint32_t offset) {
+  return ((File*)ctx)->seek(offset, SeekSet);
+}
+
+bool inicializarAlmacenPatrones() {
+  storage_ready = LittleFS.begin(true);  // Formatea si no hay sistema de ficheros
+  if (!storage_ready) {
+    Serial.println("ERROR: LittleFS no disponible");
+    return false;
+  }
+  if (!LittleFS.exists(PATTERN_FILE_DIR)) {
+    LittleFS.mkdir(PATTERN_FILE_DIR);
+  }
+  Serial.printf("LittleFS: %lu/%lu bytes usados\n", (unsigned long)LittleFS.usedBytes(),
+                (unsigned long)LittleFS.totalBytes());
+  return true;
+}
+
+void listarPatronesArchivo() {
+  if (!storage_ready) {
+    Serial.println("LittleFS no disponible");
+    return;
+  }
+  
+  File dir = LittleFS.open(PATTERN_FILE_DIR);
+  if (!dir || !dir.isDirectory()) {
+    Serial.println("Sin directorio " PATTERN_FILE_DIR);
+    return;
+  }
+  
+  // Cada fichero se valida con el mismo lector que la reproducción
+  PatternFileReader* reader = new PatternFileReader;
+  int files = 0;
+  Serial.println("=== PATRONES EN " PATTERN_FILE_DIR " ===");
+  for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    if (file.isDirectory()) continue;
+    PatternFileIo io = {leerArchivo, rebobinarArchivo, &file};
+    PatternFileInfo info;
+    PatternFileError error = patternFileValidar(reader, io, &info);
+    if (error == PATTERN_FILE_OK) {
+      Serial.printf("  %-24s %6lu B  %s  %6d pulsos  %7.1f s\n", file.name(), (unsigned long)file.size(),
+                    info.kind == PATTERN_FILE_PHASES ? "fases   " : "periodos",
+                    info.pulse_count, info.total_ms / 1000.0);
+    } else {
+      Serial.printf("  %-24s %6lu B  ERROR: %s\n", file.name(), (unsigned long)file.size(),
+                    patternFileNombreError(error));
+    }
+    files++;
+  }
+  if (files == 0) {
+    Serial.println("  (vacío) - subir con 'pio run -t uploadfs' desde data" PATTERN_FILE_DIR);
+  }
+  delete reader;
+}
+
+PatternFileError abrirPatronArchivo(const char* name, PatternFileReader* reader, PatternFileInfo* info) {
+  if (!storage_ready) return PATTERN_FILE_ERR_READ;
+  
+  cerrarPatronArchivo();
+  
+  String path = String(PATTERN_FILE_DIR) + "/" + name;
+  if (!LittleFS.exists(path) && !path.endsWith(".pat")) {
+    path += ".pat";
+  }
+  pattern_file = LittleFS.open(path, "r");
+  if (!pattern_file) return PATTERN_FILE_ERR_READ;
+  
+  PatternFileIo io = {leerArchivo, rebobinarArchivo, &pattern_file};
+  PatternFileError error = patternFileValidar(reader, io, info);
+  if (error != PATTERN_FILE_OK) {
+    cerrarPatronArchivo();
+  }
+  return error;
+}
+
+void cerrarPatronArchivo() {
+  if (pattern_file) {
+    pattern_file.close();
+  }
+}
@@ -0,0 +1,83 @@
+#include "pulse_pattern.h"
+#include "pattern_file.h"
+
+void patternStreamDesdeTabla(PatternStream* stream, const PatternTable& table) {
+  stream->source = PATTERN_SOURCE_TABLE;
+  stream->table = table;
+  stream->phases = nullptr;
+  stream->phase_count = 0;
+  stream->file = nullptr;
+  patternStreamReiniciar(stream);
+}
+
+void patternStreamDesdeFases(PatternStream* stream, const PulsePhase* phases, int phase_count) {
+  stream->source = PATTERN_SOURCE_PHASES;
+  stream->table.data = nullptr;
+  stream->table.data_size = 0;
+  stream->table.count = 0;
+  stream->table.total_ms = 0;
+  stream->phases = phases;
+  stream->phase_count = phase_count;
+  stream->file = nullptr;
+  patternStreamReiniciar(stream);
+}
+
+void patternStreamReiniciar(PatternStream* stream) {
+  periodDecoderIniciar(&stream->decoder, stream->table.data, stream->table.data_size);
+  stream->phase_index = 0;
+  stream->pulse_in_phase = 0;
+  stream->synth_phase = -1;
+  stream->pulse_number = 0;
+  if (stream->source == PATTERN_SOURCE_FILE) {
+    patternFileReiniciar(stream->file);
+  }
+}
+
+bool patternStreamSiguiente(PatternStream* stream, uint32_t* period_us) {
+  if (stream->source == PATTERN_SOURCE_TABLE) {
+    if ((int)stream->pulse_number >= stream->table.count) return false;
+    if (!periodDecoderSiguiente(&stream->decoder, period_us)) return false;
+    stream->pulse_number++;
+    return true;
+  }
+
+  if (stream->source == PATTERN_SOURCE_FILE) {
+    if (!patternFileSiguientePeriodo(stream->file, period_us)) return false;
+    stream->pulse_number++;
+    return true;
+  }
+
+  // PATTERN_SOURCE_PHASES: saltar fases agotadas (o vacías)
+  while (stream->phase_index < stream->phase_count &&
+         stream->pulse_in_phase >= stream->phases[stream->phase_index].num_pulses) {
+    stream->phase_index++;
+    stream->pulse_in_phase = 0;
+  }
+  if (stream->phase_index >= stream->phase_count) return false;
+
+  if (stream->synth_phase != stream->phase_index) {
+    patternSynthIniciarFase(&stream->synth, stream->phases[stream->phase_index]);
+    stream->synth_phase = stream->phase_index;
+  }
+  *period_us = patternSynthPeriodo(&stream->synth, stream->pulse_in_phase, (uint32_t)stream->pulse_number);
+  stream->pulse_in_phase++;
+  stream->pulse_number++;
+  return true;
+}
+
+void patternStreamRellenar(PatternStream* stream) {
+  if (stream->source == PATTERN_SOURCE_FILE) {
+    patternFileRellenar(stream->file);
+  }
+}
+
+int patternStreamLongitud(const PatternStream* stream) {
+  if (stream->source == PATTERN_SOURCE_TABLE) return stream->table.count;
+  if (stream->source == PATTERN_SOURCE_FILE) return (int)stream->file->header.count;
+
+  int total = 0;
+  for (int p = 0; p < stream->phase_count; p++) {
+    total += stream->phases[p].num_pulses;
+  }
+  return total;
+}
@@ -0,0 +1,19 @@
+#include "pulse_pattern.h"
+
+constexpr EasingLut EASING_LUT = generarLutEasing();
+
+void patternSynthIniciarFase(PhaseSynth* synth, const PulsePhase& phase) {
+  // Conversión a µs igual que el generador float: truncando
+  synth->start_us = (uint32_t)(phase.tempo_start_ms * 1000.0f);
+  synth->end_us = (uint32_t)(phase.tempo_end_ms * 1000.0f);
+  synth->delta_us = (int32_t)(synth->end_us - synth->start_us);
+  synth->num_pulses = phase.num_pulses;
+  synth->type = (uint8_t)phase.type;
+  synth->jitter_type = (uint8_t)phase.jitter_type;
+  synth->progress_step_q24 = (phase.num_pulses > 1) ? (1UL << 24) / (uint32_t)(phase.num_pulses - 1) : 0;
+
+  // Gaussiano: la suma de 4 uniformes tiene σ = 0.577; escalar a σ = jitter / 2
+  float amplitude = phase.jitter_percent / 100.0f;
+  if (phase.jitter_type == JITTER_GAUSSIAN) amplitude *= 0.8660254f;
+  synth->jitter_q16 = (phase.jitter_percent > 0.0f) ? (int32_t)(amplitude * 65536.0f + 0.5f) : 0;
+}
@@ -0,0 +1,80 @@
+#include "pulse_pattern.h"
+#include "test_cases.h"
+
+// Tablas de períodos generadas en compilación. Al ser const
+// se enlazan en .rodata (flash/DROM en ESP32): cambiar de test case no
+// recalcula nada ni ocupa RAM. Los períodos van codificados en delta
+// zig-zag varint (pattern_codec.h); los µs intermedios solo existen en
+// compilación.
+
+#define TABLA_PATRON(nombre, fases) \
+  static constexpr auto nombre##_us = generarPeriodosUs<contarPulsosFases(fases)>(fases); \
+  static constexpr PatternTableData<tamanoCompacto(nombre##_us)> nombre = \
+      generarTablaPatron<tamanoCompacto(nombre##_us)>(nombre##_us)
+
+TABLA_PATRON(tc1_table, test1_phases);
+TABLA_PATRON(tc2_table, test2_phases);
+TABLA_PATRON(tc3_table, test3_phases);
+TABLA_PATRON(tc4_table, test4_phases);
+TABLA_PATRON(tc5_table, test5_phases);
+
+template <int B>
+static PatternTable vistaTabla(const PatternTableData<B>& table) {
+  PatternTable view = {table.data, B, table.count, table.total_ms};
+  return view;
+}
+
+PatternTable obtenerTablaPatron(TestCase tc) {
+  switch (tc) {
+    case TEST_CASE_1: return vistaTabla(tc1_table);
+    case TEST_CASE_2: return vistaTabla(tc2_table);
+    case TEST_CASE_3: return vistaTabla(tc3_table);
+    case TEST_CASE_4: return vistaTabla(tc4_table);
+    case TEST_CASE_5: return vistaTabla(tc5_table);
+    default: {
+      PatternTable empty = {nullptr, 0, 0, 0};
+      return empty;
+    }
+  }
+}
+
+const PulsePhase* getTestPhases(TestCase tc, int* phase_count) {
+  switch (tc) {
+    case TEST_CASE_1:
+      *phase_count = sizeof(test1_phases) / sizeof(PulsePhase);
+      return test1_phases;
+    case TEST_CASE_2:
+      *phase_count = sizeof(test2_phases) / sizeof(PulsePhase);
+      return test2_phases;
+    case TEST_CASE_3:
+      *phase_count = sizeof(test3_phases) / sizeof(PulsePhase);
+      return test3_phases;
+    case TEST_CASE_4:
+      *phase_count = sizeof(test4_phases) / sizeof(PulsePhase);
+      return test4_phases;
+    case TEST_CASE_5:
+      *phase_count = sizeof(test5_phases) / sizeof(PulsePhase);
+      return test5_phases;
+    case TEST_CASE_9:
+      *phase_count = sizeof(test9_phases) / sizeof(PulsePhase);
+      return test9_phases;
+    default:
+      *phase_count = 0;
+      return nullptr;
+  }
+}
+
+bool abrirPatron(TestCase tc, PatternStream* stream) {
+  PatternTable table = obtenerTablaPatron(tc);
+  if (table.data) {
+    patternStreamDesdeTabla(stream, table);
+    return true;
+  }
+
+  // Sin tabla (escenarios largos): períodos calculados bajo demanda
+  int phase_count = 0;
+  const PulsePhase* phases = getTestPhases(tc, &phase_count);
+  if (!phases) return false;
+  patternStreamDesdeFases(stream, phases, phase_count);
+  return true;
+}
@@ -0,0 +1,204 @@
+#include "pressure_calibration.h"
+#include "pattern_file.h"  // patternFileCrc32
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef ARDUINO
+#include <Preferences.h>
+#endif
+
+#define PRESSURE_CAL_MAGIC 0x50434C31UL   // "PCL1"
+#define PRESSURE_CAL_SLOPE_BITS 24
+
+struct PressureCalRecord {
+  uint32_t magic;
+  PressureCalibration calibration;
+  uint32_t crc;          // De todo lo anterior
+};
+
+PressureCalibration pressure_calibration;
+
+// Pendiente de cada tramo (entre el punto i y el i+1) en Q24
+static int64_t slopes_q24[PRESSURE_CAL_MAX_POINTS];
+
+static uint32_t crcRegistro(const PressureCalRecord& record) {
+  return patternFileCrc32(0, (const uint8_t*)&record, offsetof(PressureCalRecord, crc));
+}
+
+// --- HAL: Preferences (ESP32) o memoria simulada (host) ---
+
+#ifdef ARDUINO
+
+static bool halLeer(PressureCalRecord* record) {
+  Preferences prefs;
+  if (!prefs.begin(PRESSURE_CAL_NVS_NAMESPACE, true)) return false;
+  bool ok = prefs.getBytes("tabla", record, sizeof(*record)) == sizeof(*record);
+  prefs.end();
+  return ok;
+}
+
+static bool halEscribir(const PressureCalRecord& record) {
+  Preferences prefs;
+  if (!prefs.begin(PRESSURE_CAL_NVS_NAMESPACE, false)) return false;
+  bool ok = prefs.putBytes("tabla", &record, sizeof(record)) == sizeof(record);
+  prefs.end();
+  return ok;
+}
+
+#else
+
+static PressureCalRecord host_record;
+static bool host_written = false;
+
+static bool halLeer(PressureCalRecord* record) {
+  if (!host_written) return false;
+  *record = host_record;
+  return true;
+}
+
+static bool halEscribir(const PressureCalRecord& record) {
+  host_record = record;
+  host_written = true;
+  return true;
+}
+
+#endif
+
+static int64_t pendienteTramo(const PressureCalPoint& a, const PressureCalPoint& b) {
+  int64_t dp = (int64_t)b.pa - a.pa;
+  int64_t dr = (int64_t)b.raw - a.raw;
+  return (dp * ((int64_t)1 << PRESSURE_CAL_SLOPE_BITS)) / dr;
+}
+
+static bool pendienteValida(const PressureCalPoint& a, const PressureCalPoint& b) {
+  int64_t dp = (int64_t)b.pa - a.pa;
+  int64_t dr = (int64_t)b.raw - a.raw;
+  return dr > 0 && dp >= 0 && dp <= dr * PRESSURE_CAL_MAX_SLOPE;
+}
+
+static void precalcularPendientes() {
+  for (int i = 0; i + 1 < pressure_calibration.count; i++) {
+    slopes_q24[i] = pendienteTramo(pressure_calibration.points[i], pressure_calibration.points[i + 1]);
+  }
+}
+
+static bool tablaValida(const PressureCalibration& calibration) {
+  if (calibration.count < 0 || calibration.count > PRESSURE_CAL_MAX_POINTS) return false;
+  if (calibration.unit != PRESSURE_UNIT_KPA && calibration.unit != PRESSURE_UNIT_BAR) return false;
+  for (int i = 0; i < calibration.count; i++) {
+    if (calibration.points[i].raw > PRESSURE_CAL_MAX_RAW) return false;
+  }
+  for (int i = 0; i + 1 < calibration.count; i++) {
+    if (!pendienteValida(calibration.points[i], calibration.points[i + 1])) return false;
+  }
+  return true;
+}
+
+static void guardar() {
+  PressureCalRecord record;
+  memset(&record, 0, sizeof(record));
+  record.magic = PRESSURE_CAL_MAGIC;
+  record.calibration = pressure_calibration;
+  record.crc = crcRegistro(record);
+  halEscribir(record);
+}
+
+void calibracionPresionIniciar() {
+  PressureCalRecord record;
+  if (halLeer(&record) && record.magic == PRESSURE_CAL_MAGIC && record.crc == crcRegistro(record) &&
+      tablaValida(record.calibration)) {
+    pressure_calibration = record.calibration;
+  } else {
+    memset(&pressure_calibration, 0, sizeof(pressure_calibration));
+    pressure_calibration.unit = PRESSURE_UNIT_KPA;
+  }
+  precalcularPendientes();
+}
+
+bool calibracionPresionActiva() {
+  return pressure_calibration.count >= 2;
+}
+
+int32_t calibracionPresionPa(uint32_t raw) {
+  const PressureCalPoint* points = pressure_calibration.points;
+  if (pressure_calibration.count < 2) return 0;
+
+  // Último tramo cuyo inicio no supera raw (los extremos se prolongan)
+  int lo = 0;
+  int hi = pressure_calibration.count - 2;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (points[mid].raw <= raw) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+
+  // |offset| < 2^24 y |pendiente| <= 2^38: el producto cabe en 64 bits
+  if (raw > PRESSURE_CAL_MAX_RAW) raw = PRESSURE_CAL_MAX_RAW;
+  int64_t offset = (int64_t)raw - points[lo].raw;
+  int64_t delta = (offset * slopes_q24[lo] + ((int64_t)1 << (PRESSURE_CAL_SLOPE_BITS - 1))) >> PRESSURE_CAL_SLOPE_BITS;
+  int64_t pa = points[lo].pa + delta;
+  if (pa > INT32_MAX) return INT32_MAX;
+  if (pa < INT32_MIN) return INT32_MIN;
+  return (int32_t)pa;
+}
+
+float calibracionPresionPaPorUnidad() {
+  return (pressure_calibration.unit == PRESSURE_UNIT_BAR) ? 100000.0f : 1000.0f;
+}
+
+float calibracionPresionValor(uint32_t raw) {
+  if (!calibracionPresionActiva()) return (float)raw;
+  return calibracionPresionPa(raw) / calibracionPresionPaPorUnidad();
+}
+
+const char* calibracionPresionNombreUnidad() {
+  if (!calibracionPresionActiva()) return "";
+  return (pressure_calibration.unit == PRESSURE_UNIT_BAR) ? "bar" : "kPa";
+}
+
+bool calibracionPresionAgregar(uint32_t raw, float value) {
+  PressureCalibration updated = pressure_calibration;
+  double pa = (double)value * calibracionPresionPaPorUnidad();
+  if (!(fabs(pa) < 2.0e9)) return false;
+
+  // Misma lectura: se sustituye; si no, inserción ordenada
+  int i = 0;
+  while (i < updated.count && updated.points[i].raw < raw) i++;
+  if (i >= updated.count || updated.points[i].raw != raw) {
+    if (updated.count >= PRESSURE_CAL_MAX_POINTS) return false;
+    memmove(&updated.points[i + 1], &updated.points[i], (updated.count - i) * sizeof(PressureCalPoint));
+    updated.count++;
+  }
+  updated.points[i].raw = raw;
+  updated.points[i].pa = (int32_t)lround(pa);
+  if (!tablaValida(updated)) return false;
+
+  pressure_calibration = updated;
+  precalcularPendientes();
+  guardar();
+  return true;
+}
+
+bool calibracionPresionBorrarPunto(int index) {
+  if (index < 0 || index >= pressure_calibration.count) return false;
+  PressureCalPoint* points = pressure_calibration.points;
+  memmove(&points[index], &points[index + 1], (pressure_calibration.count - index - 1) * sizeof(PressureCalPoint));
+  pressure_calibration.count--;
+  precalcularPendientes();
+  guardar();
+  return true;
+}
+
+void calibracionPresionBorrar() {
+  pressure_calibration.count = 0;
+  guardar();
+}
+
+void calibracionPresionUnidad(PressureUnit unit) {
+  pressure_calibration.unit = unit;
+  guardar();
+}
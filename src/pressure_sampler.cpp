@@ -0,0 +1,231 @@
+#include "pressure_sampler.h"
+#include "pressure_sensor.h"
+#include "cic_decimator.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#define IRAM_ATTR
+#endif
+
+// Anillo SPSC entre núcleos: la tarea escribe head y el loop tail. Como
+// productor y consumidor corren en núcleos distintos, los índices se
+// publican con release/acquire para que el dato se vea antes que el índice.
+template <int N>
+struct PressureSampleRing {
+  static_assert((N & (N - 1)) == 0, "el tamaño del anillo debe ser potencia de 2");
+  PressureSample data[N];
+  uint32_t head;
+  uint32_t tail;
+};
+
+volatile PressureSamplerStats pressure_sampler_stats;
+
+static PressureSampleRing<PRESSURE_SAMPLE_RING_SIZE> sample_ring;
+static PressureSampleRing<PRESSURE_RAW_RING_SIZE> raw_ring;
+static CicDecimator decimator;
+static volatile bool sampler_active = false;
+static volatile uint32_t last_tick_us = 0;   // micros() de la última interrupción del timer
+
+template <int N>
+static void anilloVaciar(PressureSampleRing<N>* ring) {
+  ring->head = 0;
+  ring->tail = 0;
+}
+
+template <int N>
+static bool anilloInsertar(PressureSampleRing<N>* ring, const PressureSample& sample) {
+  uint32_t head = ring->head;
+  if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= (uint32_t)N) return false;
+  ring->data[head & (N - 1)] = sample;
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+template <int N>
+static bool anilloLeer(PressureSampleRing<N>* ring, PressureSample* sample) {
+  uint32_t tail = ring->tail;
+  if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) return false;
+  *sample = ring->data[tail & (N - 1)];
+  __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+bool muestreoPresionLeer(PressureSample* sample) {
+  return anilloLeer(&sample_ring, sample);
+}
+
+bool muestreoPresionLeerCompleta(PressureSample* sample) {
+  return anilloLeer(&raw_ring, sample);
+}
+
+// --- HAL: hw_timer + tarea FreeRTOS (ESP32) o períodos inyectados (host) ---
+
+#ifdef ARDUINO
+
+static hw_timer_t* sampler_timer = nullptr;
+static TaskHandle_t sampler_task = nullptr;
+static volatile bool task_working = false;
+
+static uint32_t halMicros() {
+  return micros();
+}
+
+static void IRAM_ATTR temporizadorIsr() {
+  pressure_sampler_stats.ticks++;
+  last_tick_us = micros();
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(sampler_task, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+#else
+
+static uint32_t host_now_us = 0;
+static uint32_t host_pending = 0;
+
+static uint32_t halMicros() {
+  return host_now_us;
+}
+
+#endif
+
+static void publicarMuestra(uint32_t t_us, uint32_t raw) {
+  PressureSample sample;
+  sample.t_us = t_us;
+  sample.raw = raw;
+  pressure_sampler_stats.samples++;
+  if (!anilloInsertar(&raw_ring, sample)) pressure_sampler_stats.raw_overflows++;
+
+  int32_t decimated;
+  if (cicAgregar(&decimator, (int32_t)raw, &decimated)) {
+    sample.raw = (uint32_t)decimated;
+    pressure_sampler_stats.outputs++;
+    if (!anilloInsertar(&sample_ring, sample)) pressure_sampler_stats.overflows++;
+  }
+}
+
+// Un período: recoge la conversión pedida antes y pide la siguiente.
+// pending > 1 son períodos que ya no se atienden.
+static void atenderPeriodo(uint32_t pending) {
+  if (pending > 1) pressure_sampler_stats.missed += pending - 1;
+
+  uint32_t start_us = halMicros();
+  uint32_t latency_us = start_us - last_tick_us;
+  if (latency_us > pressure_sampler_stats.max_latency_us) pressure_sampler_stats.max_latency_us = latency_us;
+
+  uint32_t raw = 0;
+  PressureSensorResult result = sensorPresionServicio(start_us, &raw);
+  if (result == PRESSURE_SENSOR_OK) {
+    publicarMuestra(sensorPresionInicioUs(), raw);
+  } else if (result == PRESSURE_SENSOR_ERROR) {
+    pressure_sampler_stats.errors++;
+  }
+  if (sensorPresionEstado() == PRESSURE_SENSOR_IDLE) {
+    sensorPresionSolicitar(halMicros());
+  }
+
+  uint32_t work_us = halMicros() - start_us;
+  pressure_sampler_stats.busy_us += work_us;
+  if (work_us > pressure_sampler_stats.max_work_us) pressure_sampler_stats.max_work_us = work_us;
+}
+
+#ifdef ARDUINO
+
+static void tareaMuestreo(void* arg) {
+  for (;;) {
+    uint32_t pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    task_working = true;
+    if (sampler_active) atenderPeriodo(pending);
+    task_working = false;
+  }
+}
+
+static bool halIniciar(uint32_t period_us) {
+  if (!sampler_task) {
+    if (xTaskCreatePinnedToCore(tareaMuestreo, "presion", PRESSURE_SAMPLER_STACK, nullptr,
+                                PRESSURE_SAMPLER_PRIORITY, &sampler_task, PRESSURE_SAMPLER_CORE) != pdPASS) {
+      sampler_task = nullptr;
+      return false;
+    }
+  }
+  if (!sampler_timer) {
+    sampler_timer = timerBegin(PRESSURE_SAMPLER_TIMER, 80, true);  // 80 MHz / 80 = 1 µs por tick
+    if (!sampler_timer) return false;
+    timerAttachInterrupt(sampler_timer, temporizadorIsr, true);
+  }
+  timerWrite(sampler_timer, 0);
+  timerAlarmWrite(sampler_timer, period_us, true);
+  timerAlarmEnable(sampler_timer);
+  return true;
+}
+
+// Al volver, la tarea no está usando el bus: se puede reconfigurar
+static void halDetener() {
+  if (sampler_timer) timerAlarmDisable(sampler_timer);
+  while (task_working) {
+    vTaskDelay(1);
+  }
+}
+
+#else
+
+static bool halIniciar(uint32_t period_us) {
+  host_pending = 0;
+  return true;
+}
+
+static void halDetener() {
+}
+
+void muestreoPresionHostTimer(uint32_t tick_us) {
+  if (!sampler_active) return;
+  pressure_sampler_stats.ticks++;
+  last_tick_us = tick_us;
+  host_pending++;
+}
+
+void muestreoPresionHostTarea(uint32_t now_us) {
+  host_now_us = now_us;
+  uint32_t pending = host_pending;
+  host_pending = 0;
+  if (sampler_active && pending > 0) atenderPeriodo(pending);
+}
+
+#endif
+
+bool muestreoPresionIniciar(uint32_t period_us, int cic_order, int decimation) {
+  muestreoPresionDetener();
+  if (!cicIniciar(&decimator, cic_order, decimation)) return false;
+
+  anilloVaciar(&sample_ring);
+  anilloVaciar(&raw_ring);
+  pressure_sampler_stats.ticks = 0;
+  pressure_sampler_stats.samples = 0;
+  pressure_sampler_stats.outputs = 0;
+  pressure_sampler_stats.errors = 0;
+  pressure_sampler_stats.missed = 0;
+  pressure_sampler_stats.overflows = 0;
+  pressure_sampler_stats.raw_overflows = 0;
+  pressure_sampler_stats.max_latency_us = 0;
+  pressure_sampler_stats.max_work_us = 0;
+  pressure_sampler_stats.busy_us = 0;
+
+  sampler_active = true;
+  if (!halIniciar(period_us)) {
+    sampler_active = false;
+  }
+  return sampler_active;
+}
+
+void muestreoPresionDetener() {
+  if (!sampler_active) return;
+  sampler_active = false;
+  halDetener();
+}
+
+bool muestreoPresionActivo() {
+  return sampler_active;
+}
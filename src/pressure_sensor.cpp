@@ -0,0 +1,207 @@
+#include "pressure_sensor.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <Wire.h>
+#endif
+
+#define WNK1MA_RAW_MAX 16777215   // 24 bits todos a 1: bus flotando
+
+PressureSensorStats pressure_sensor_stats;
+
+static PressureSensorState state = PRESSURE_SENSOR_IDLE;
+static uint32_t state_since_us = 0;
+static int attempts = 0;          // Fallos de la lectura en curso
+static uint32_t bus_clock_hz = I2C_CLOCK_HZ;
+
+// --- HAL: Wire (ESP32) o sensor simulado (host) ---
+
+#ifdef ARDUINO
+
+#define I2C_RECOVERY_HALF_CLOCK_US 5   // SCL a ~100 kHz
+
+static uint32_t halRelojUs() {
+  return micros();
+}
+
+static void halIniciar() {
+  Wire.begin(I2C_SDA, I2C_SCL);
+  Wire.setClock(bus_clock_hz);
+  Wire.setTimeOut(WNK1MA_I2C_TIMEOUT_MS);
+}
+
+static bool halEnviarOrden() {
+  Wire.beginTransmission(WNK1MA_ADDR);
+  Wire.write(WNK1MA_CMD);
+  return Wire.endTransmission(true) == 0;
+}
+
+static bool halLeerValor(uint32_t* raw) {
+  if (Wire.requestFrom(WNK1MA_ADDR, 3) != 3) return false;
+  uint32_t value = (uint32_t)Wire.read() << 16;
+  value |= (uint32_t)Wire.read() << 8;
+  value |= (uint32_t)Wire.read();
+  *raw = value;
+  return true;
+}
+
+// Un esclavo que se quedó a mitad de byte retiene SDA: se le dan pulsos de
+// SCL hasta que la suelte, se genera un STOP y se reinicia el controlador
+static void halRecuperarBus() {
+  Wire.end();
+  pinMode(I2C_SDA, INPUT_PULLUP);
+  pinMode(I2C_SCL, OUTPUT_OPEN_DRAIN);
+  digitalWrite(I2C_SCL, HIGH);
+  for (int i = 0; i < 9 && digitalRead(I2C_SDA) == LOW; i++) {
+    digitalWrite(I2C_SCL, LOW);
+    delayMicroseconds(I2C_RECOVERY_HALF_CLOCK_US);
+    digitalWrite(I2C_SCL, HIGH);
+    delayMicroseconds(I2C_RECOVERY_HALF_CLOCK_US);
+  }
+  // STOP: SDA sube con SCL alto
+  pinMode(I2C_SDA, OUTPUT_OPEN_DRAIN);
+  digitalWrite(I2C_SDA, LOW);
+  delayMicroseconds(I2C_RECOVERY_HALF_CLOCK_US);
+  digitalWrite(I2C_SDA, HIGH);
+  delayMicroseconds(I2C_RECOVERY_HALF_CLOCK_US);
+  halIniciar();
+}
+
+#else
+
+static uint32_t host_raw = 0x400000;
+static int host_write_failures = 0;
+static int host_read_failures = 0;
+
+static uint32_t halRelojUs() {
+  return 0;   // En host las transacciones no cuestan tiempo
+}
+
+static void halIniciar() {
+}
+
+static bool halEnviarOrden() {
+  if (host_write_failures > 0) {
+    host_write_failures--;
+    return false;
+  }
+  return true;
+}
+
+static bool halLeerValor(uint32_t* raw) {
+  if (host_read_failures > 0) {
+    host_read_failures--;
+    return false;
+  }
+  *raw = host_raw;
+  return true;
+}
+
+static void halRecuperarBus() {
+}
+
+void sensorPresionHostValor(uint32_t raw) {
+  host_raw = raw;
+}
+
+void sensorPresionHostFallos(int write_failures, int read_failures) {
+  host_write_failures = write_failures;
+  host_read_failures = read_failures;
+}
+
+#endif
+
+static void anotarDuracion(uint32_t start_us) {
+  uint32_t busy_us = halRelojUs() - start_us;
+  if (busy_us > pressure_sensor_stats.max_busy_us) pressure_sensor_stats.max_busy_us = busy_us;
+}
+
+static void registrarFallo(uint32_t now_us) {
+  pressure_sensor_stats.errors++;
+  attempts++;
+  state_since_us = now_us;
+  if (attempts <= WNK1MA_MAX_RETRIES) {
+    pressure_sensor_stats.retries++;
+    state = PRESSURE_SENSOR_RETRY_WAIT;
+    return;
+  }
+  pressure_sensor_stats.recoveries++;
+  halRecuperarBus();
+  state = PRESSURE_SENSOR_FAILED;
+}
+
+static void enviarOrden(uint32_t now_us) {
+  uint32_t start_us = halRelojUs();
+  bool ok = halEnviarOrden();
+  anotarDuracion(start_us);
+  if (!ok) {
+    registrarFallo(now_us);
+    return;
+  }
+  state = PRESSURE_SENSOR_CONVERTING;
+  state_since_us = now_us;
+}
+
+void sensorPresionIniciar() {
+  halIniciar();
+  state = PRESSURE_SENSOR_IDLE;
+  attempts = 0;
+}
+
+void sensorPresionReloj(uint32_t clock_hz) {
+  bus_clock_hz = clock_hz;
+  sensorPresionIniciar();
+}
+
+bool sensorPresionSolicitar(uint32_t now_us) {
+  if (state != PRESSURE_SENSOR_IDLE) return false;
+  attempts = 0;
+  enviarOrden(now_us);
+  return true;
+}
+
+PressureSensorResult sensorPresionServicio(uint32_t now_us, uint32_t* raw) {
+  switch (state) {
+    case PRESSURE_SENSOR_IDLE:
+      return PRESSURE_SENSOR_BUSY;
+
+    case PRESSURE_SENSOR_RETRY_WAIT:
+      if (now_us - state_since_us >= WNK1MA_RETRY_DELAY_US) enviarOrden(now_us);
+      break;
+
+    case PRESSURE_SENSOR_CONVERTING: {
+      if (now_us - state_since_us < WNK1MA_CONVERSION_US) return PRESSURE_SENSOR_BUSY;
+      uint32_t value = 0;
+      uint32_t start_us = halRelojUs();
+      bool ok = halLeerValor(&value);
+      anotarDuracion(start_us);
+      if (ok && value > 0 && value < WNK1MA_RAW_MAX) {
+        pressure_sensor_stats.readings++;
+        state = PRESSURE_SENSOR_IDLE;
+        *raw = value;
+        return PRESSURE_SENSOR_OK;
+      }
+      registrarFallo(now_us);
+      break;
+    }
+
+    case PRESSURE_SENSOR_FAILED:
+      break;
+  }
+
+  // Un fallo definitivo se informa una vez y el sensor queda libre
+  if (state == PRESSURE_SENSOR_FAILED) {
+    pressure_sensor_stats.failures++;
+    state = PRESSURE_SENSOR_IDLE;
+    return PRESSURE_SENSOR_ERROR;
+  }
+  return PRESSURE_SENSOR_BUSY;
+}
+
+PressureSensorState sensorPresionEstado() {
+  return state;
+}
+
+uint32_t sensorPresionInicioUs() {
+  return state_since_us;
+}
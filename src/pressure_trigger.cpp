@@ -0,0 +1,300 @@
+#include "pressure_trigger.h"
+#include "pressure_calibration.h"
+#include "timestamp_ring.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#define IRAM_ATTR
+#endif
+
+PressureTriggerConfig pressure_trigger_config = {
+  PRESSURE_TRIGGER_LEVEL, PRESSURE_EDGE_RISE, 0.0f, 0.0f, 1,
+  PRESSURE_TRIGGER_PRE_DEFAULT, PRESSURE_TRIGGER_POST_DEFAULT, false, false
+};
+PressureTriggerStats pressure_trigger_stats;
+
+static PressureCapture captures[PRESSURE_CAPTURE_SLOTS];
+static int next_slot = 0;                // Hueco en uso o el siguiente
+static uint32_t capture_seq = 0;
+static PressureCaptureState state = PRESSURE_CAPTURE_IDLE;
+static int write_pos = 0;
+static int written = 0;                  // Muestras en el hueco desde que se empezó a llenar
+static int remaining = 0;                // Posteriores que faltan
+
+// Magnitud vigilada y detectores (uno por sentido)
+static bool rise_armed = false;
+static bool fall_armed = false;
+static bool have_previous = false;
+static int32_t previous_value = 0;
+static uint32_t previous_t_us = 0;
+static float rate_average = 0.0f;
+static int32_t slope_history[PRESSURE_TRIGGER_SLOPE_MAX];
+static int slope_pos = 0;
+static int slope_count = 0;
+
+static TimestampRing<PRESSURE_TRIGGER_PULSE_RING_SIZE> pulse_ring;
+
+// --- HAL: interrupción del pulso externo (ESP32) o pulsos inyectados (host) ---
+
+#ifdef ARDUINO
+
+static void IRAM_ATTR pulsoExternoIsr() {
+  timestampRingInsertar(&pulse_ring, (uint32_t)micros());
+}
+
+static void halPulsos(bool enable) {
+  static bool attached = false;
+  if (enable && !attached) {
+    pinMode(PRESSURE_TRIGGER_PIN, INPUT);
+    attachInterrupt(digitalPinToInterrupt(PRESSURE_TRIGGER_PIN), pulsoExternoIsr, RISING);
+  } else if (!enable && attached) {
+    detachInterrupt(digitalPinToInterrupt(PRESSURE_TRIGGER_PIN));
+  }
+  attached = enable;
+}
+
+#else
+
+static void halPulsos(bool enable) {
+}
+
+void disparoPresionHostPulso(uint32_t t_us) {
+  timestampRingInsertar(&pulse_ring, t_us);
+}
+
+#endif
+
+static int32_t valorMuestra(uint32_t raw) {
+  return pressure_trigger_config.calibrated ? calibracionPresionPa(raw) : (int32_t)raw;
+}
+
+// Nivel, salto en span muestras o dP/dt suavizada por segundo
+static float magnitudVigilada(int32_t value, uint32_t t_us) {
+  const PressureTriggerConfig& config = pressure_trigger_config;
+  float magnitude = 0.0f;
+
+  if (config.mode == PRESSURE_TRIGGER_LEVEL) {
+    magnitude = (float)value;
+  } else if (config.mode == PRESSURE_TRIGGER_SLOPE) {
+    // slope_history[slope_pos] es la muestra de hace span
+    if (slope_count == config.span) {
+      magnitude = (float)(value - slope_history[slope_pos]);
+    } else {
+      slope_count++;
+    }
+    slope_history[slope_pos] = value;
+    slope_pos = (slope_pos + 1) % config.span;
+  } else if (config.mode == PRESSURE_TRIGGER_RATE) {
+    uint32_t dt_us = t_us - previous_t_us;
+    if (have_previous && dt_us > 0) {
+      float rate = (value - previous_value) * 1000000.0f / dt_us;
+      rate_average += (rate - rate_average) / PRESSURE_TRIGGER_RATE_SMOOTH;
+    }
+    magnitude = rate_average;
+  }
+
+  have_previous = true;
+  previous_value = value;
+  previous_t_us = t_us;
+  return magnitude;
+}
+
+// Cruce hacia arriba de threshold, tras haber bajado de threshold - hysteresis
+static bool detectarCruce(bool* armed, float magnitude, float threshold, float hysteresis) {
+  bool crossed = *armed && magnitude >= threshold;
+  if (magnitude >= threshold) {
+    *armed = false;
+  } else if (magnitude < threshold - hysteresis) {
+    *armed = true;
+  }
+  return crossed;
+}
+
+static bool evaluarDisparo(float magnitude) {
+  const PressureTriggerConfig& config = pressure_trigger_config;
+  // Nivel: bajar de threshold es subir de -threshold; salto y dP/dt: misma magnitud hacia abajo
+  float fall_threshold = (config.mode == PRESSURE_TRIGGER_LEVEL) ? -config.threshold : config.threshold;
+  bool rise = detectarCruce(&rise_armed, magnitude, config.threshold, config.hysteresis);
+  bool fall = detectarCruce(&fall_armed, -magnitude, fall_threshold, config.hysteresis);
+
+  if (config.edge == PRESSURE_EDGE_RISE) return rise;
+  if (config.edge == PRESSURE_EDGE_FALL) return fall;
+  return rise || fall;
+}
+
+// Pulsos anteriores a la muestra: el primero dispara si está armado. La
+// muestra que lo sigue llega al anillo un período después de pedirla, y para
+// entonces la ISR ya ha dejado el pulso: no se adelanta ninguna.
+static bool pulsoAlcanzado(uint32_t t_us, uint32_t* pulse_us) {
+  bool reached = false;
+  while (timestampRingPendientes(&pulse_ring) > 0) {
+    uint32_t next_us = pulse_ring.data[pulse_ring.tail & (PRESSURE_TRIGGER_PULSE_RING_SIZE - 1)];
+    if ((int32_t)(t_us - next_us) < 0) break;
+    timestampRingLeer(&pulse_ring, &next_us);
+    pressure_trigger_stats.pulses++;
+    if (!reached && state == PRESSURE_CAPTURE_ARMED) {
+      *pulse_us = next_us;
+      reached = true;
+    } else {
+      pressure_trigger_stats.pulses_ignored++;
+    }
+  }
+  return reached;
+}
+
+static void empezarHueco() {
+  write_pos = 0;
+  written = 0;
+  captures[next_slot].valid = false;
+  state = PRESSURE_CAPTURE_FILLING;
+}
+
+static void cerrarCaptura() {
+  PressureCapture* capture = &captures[next_slot];
+  capture->length = pressure_trigger_config.pre + pressure_trigger_config.post;
+  capture->start = write_pos;
+  capture->seq = ++capture_seq;
+  capture->valid = true;
+  next_slot = (next_slot + 1) % PRESSURE_CAPTURE_SLOTS;
+
+  if (pressure_trigger_config.single) {
+    state = PRESSURE_CAPTURE_IDLE;
+    disparoPresionDetener();
+  } else {
+    empezarHueco();
+  }
+}
+
+void disparoPresionAgregar(const PressureSample& sample) {
+  if (state == PRESSURE_CAPTURE_IDLE) return;
+  if (calibracionPresionActiva() != pressure_trigger_config.calibrated) {
+    disparoPresionDetener();
+    return;
+  }
+
+  const PressureTriggerConfig& config = pressure_trigger_config;
+  int length = config.pre + config.post;
+  PressureCapture* capture = &captures[next_slot];
+  capture->samples[write_pos] = sample;
+  write_pos = (write_pos + 1) % length;
+  written++;
+  // La muestra que completa las previas ya puede disparar
+  if (state == PRESSURE_CAPTURE_FILLING && written > config.pre) state = PRESSURE_CAPTURE_ARMED;
+
+  uint32_t trigger_us = sample.t_us;
+  bool fired;
+  if (config.mode == PRESSURE_TRIGGER_PULSE) {
+    fired = pulsoAlcanzado(sample.t_us, &trigger_us);
+  } else {
+    fired = evaluarDisparo(magnitudVigilada(valorMuestra(sample.raw), sample.t_us));
+  }
+
+  if (state == PRESSURE_CAPTURE_ARMED) {
+    if (!fired) return;
+    pressure_trigger_stats.triggers++;
+    capture->mode = config.mode;
+    capture->trigger_t_us = trigger_us;
+    capture->pre = config.pre;
+    remaining = config.post - 1;
+    state = PRESSURE_CAPTURE_POST;
+  } else if (state == PRESSURE_CAPTURE_POST) {
+    remaining--;
+  } else {
+    return;
+  }
+  if (remaining == 0) cerrarCaptura();
+}
+
+bool disparoPresionConfigurar(const PressureTriggerConfig& config) {
+  if (config.pre < 0 || config.post < 1 || config.pre + config.post > PRESSURE_CAPTURE_MAX) return false;
+  if (config.mode == PRESSURE_TRIGGER_SLOPE && (config.span < 1 || config.span > PRESSURE_TRIGGER_SLOPE_MAX)) {
+    return false;
+  }
+  if (config.mode != PRESSURE_TRIGGER_LEVEL && config.mode != PRESSURE_TRIGGER_PULSE && !(config.threshold > 0.0f)) {
+    return false;
+  }
+  if (!(config.hysteresis >= 0.0f)) return false;
+
+  disparoPresionDetener();
+  pressure_trigger_config = config;
+  pressure_trigger_config.calibrated = calibracionPresionActiva();
+  disparoPresionArmar();
+  return true;
+}
+
+void disparoPresionArmar() {
+  rise_armed = false;
+  fall_armed = false;
+  have_previous = false;
+  rate_average = 0.0f;
+  slope_pos = 0;
+  slope_count = 0;
+  pressure_trigger_config.calibrated = calibracionPresionActiva();
+  timestampRingVaciar(&pulse_ring);
+  halPulsos(pressure_trigger_config.mode == PRESSURE_TRIGGER_PULSE);
+  empezarHueco();
+}
+
+void disparoPresionDetener() {
+  halPulsos(false);
+  pressure_trigger_stats.pulse_overflows += pulse_ring.overflows;
+  pulse_ring.overflows = 0;
+  // Un hueco a medias no es una captura
+  if (state != PRESSURE_CAPTURE_IDLE) captures[next_slot].valid = false;
+  state = PRESSURE_CAPTURE_IDLE;
+}
+
+PressureCaptureState disparoPresionEstado() {
+  return state;
+}
+
+const PressureCapture* disparoPresionCaptura(int age) {
+  if (age < 0 || age >= PRESSURE_CAPTURE_SLOTS) return nullptr;
+  const PressureCapture* capture = &captures[(next_slot - 1 - age + 2 * PRESSURE_CAPTURE_SLOTS) % PRESSURE_CAPTURE_SLOTS];
+  return capture->valid ? capture : nullptr;
+}
+
+PressureSample capturaPresionMuestra(const PressureCapture* capture, int index) {
+  return capture->samples[(capture->start + index) % capture->length];
+}
+
+void capturaPresionVista(const PressureCapture* capture, int zoom, PressureCaptureView* view) {
+  if (zoom < 1) zoom = 1;
+  if (zoom > PRESSURE_CAPTURE_MAX_ZOOM) zoom = PRESSURE_CAPTURE_MAX_ZOOM;
+
+  // Tramo visible centrado en el disparo, sin salirse de la captura
+  int visible = capture->length / zoom;
+  if (visible < 2) visible = (capture->length < 2) ? capture->length : 2;
+  int first = capture->pre - visible / 2;
+  if (first + visible > capture->length) first = capture->length - visible;
+  if (first < 0) first = 0;
+
+  // Con menos muestras que columnas, cada muestra ocupa varias
+  view->width = GRAPH_WIDTH;
+  view->trigger_x = -1;
+  view->scale_min = 0.0f;
+  view->scale_max = 0.0f;
+  for (int x = 0; x < view->width; x++) {
+    int from = first + (int)((int64_t)x * visible / view->width);
+    int to = first + (int)((int64_t)(x + 1) * visible / view->width);
+    if (to <= from) to = from + 1;
+    // Incluye la primera muestra de la columna siguiente para que el trazo sea continuo
+    int last = (to < first + visible) ? to : to - 1;
+    for (int i = from; i <= last; i++) {
+      float value = calibracionPresionValor(capturaPresionMuestra(capture, i).raw);
+      if (i == from || value < view->value_min[x]) view->value_min[x] = value;
+      if (i == from || value > view->value_max[x]) view->value_max[x] = value;
+    }
+    if (x == 0 || view->value_min[x] < view->scale_min) view->scale_min = view->value_min[x];
+    if (x == 0 || view->value_max[x] > view->scale_max) view->scale_max = view->value_max[x];
+    if (view->trigger_x < 0 && capture->pre >= from && capture->pre < to) view->trigger_x = x;
+  }
+
+  float range = view->scale_max - view->scale_min;
+  float margin = (range > 0) ? range * 0.05f : 10.0f;
+  view->scale_min -= margin;
+  view->scale_max += margin;
+  view->first_us = (int32_t)(capturaPresionMuestra(capture, first).t_us - capture->trigger_t_us);
+  view->last_us = (int32_t)(capturaPresionMuestra(capture, first + visible - 1).t_us - capture->trigger_t_us);
+}
@@ -0,0 +1,59 @@
+#include "pulse_capture.h"
+#include "pulse_output.h"
+#include "timestamp_ring.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#define IRAM_ATTR
+#endif
+
+static TimestampRing<PULSE_CAPTURE_RING_SIZE> capture_ring;
+static int capture_pin = -1;
+
+volatile uint32_t pulse_capture_overflows = 0;
+
+static void IRAM_ATTR registrarFlanco(uint32_t t_us) {
+  if (!timestampRingInsertar(&capture_ring, t_us)) {
+    pulse_capture_overflows++;
+  }
+}
+
+#ifdef ARDUINO
+static void IRAM_ATTR pulseCaptureIsr() {
+  registrarFlanco((uint32_t)pulseOutputAhoraUs());
+}
+#endif
+
+void pulseCaptureIniciar(uint8_t pin) {
+  pulseCaptureDetener();
+  timestampRingVaciar(&capture_ring);
+  pulse_capture_overflows = 0;
+  capture_pin = pin;
+#ifdef ARDUINO
+  pinMode(pin, INPUT);
+  attachInterrupt(digitalPinToInterrupt(pin), pulseCaptureIsr, RISING);
+#endif
+}
+
+void pulseCaptureDetener() {
+  if (capture_pin < 0) return;
+#ifdef ARDUINO
+  detachInterrupt(digitalPinToInterrupt(capture_pin));
+#endif
+  capture_pin = -1;
+}
+
+bool pulseCaptureLeer(uint32_t* t_us) {
+  return timestampRingLeer(&capture_ring, t_us);
+}
+
+int pulseCapturePendientes() {
+  return timestampRingPendientes(&capture_ring);
+}
+
+#ifndef ARDUINO
+void pulseCaptureHostRegistrar(uint32_t t_us) {
+  registrarFlanco(t_us);
+}
+#endif
@@ -0,0 +1,155 @@
+#include "pulse_counter.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "driver/pcnt.h"
+#else
+#define IRAM_ATTR
+#endif
+
+#define PULSE_COUNTER_APB_MHZ 80
+#define PULSE_COUNTER_FILTER_MAX 1023
+
+volatile uint32_t pulse_counter_wraps = 0;
+
+static bool counter_active = false;
+static uint64_t last_total = 0;
+
+static void IRAM_ATTR contarVuelta(void* arg) {
+  pulse_counter_wraps++;
+}
+
+// --- HAL: unidad PCNT (ESP32) o contador simulado (host) ---
+
+#ifdef ARDUINO
+
+#define PULSE_COUNTER_PCNT_UNIT ((pcnt_unit_t)PULSE_COUNTER_UNIT)
+
+static bool isr_service_installed = false;
+
+static bool halIniciar(uint8_t pin, uint16_t filter_cycles) {
+  pcnt_config_t config = {};
+  config.pulse_gpio_num = pin;
+  config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+  config.lctrl_mode = PCNT_MODE_KEEP;
+  config.hctrl_mode = PCNT_MODE_KEEP;
+  config.pos_mode = PCNT_COUNT_INC;   // Flanco de subida
+  config.neg_mode = PCNT_COUNT_DIS;
+  config.counter_h_lim = PULSE_COUNTER_LIMIT;
+  config.counter_l_lim = -1;          // Solo cuenta hacia arriba: no se alcanza
+  config.unit = PULSE_COUNTER_PCNT_UNIT;
+  config.channel = PCNT_CHANNEL_0;
+  if (pcnt_unit_config(&config) != ESP_OK) return false;
+
+  if (filter_cycles > 0) {
+    pcnt_set_filter_value(PULSE_COUNTER_PCNT_UNIT, filter_cycles);
+    pcnt_filter_enable(PULSE_COUNTER_PCNT_UNIT);
+  } else {
+    pcnt_filter_disable(PULSE_COUNTER_PCNT_UNIT);
+  }
+
+  pcnt_event_enable(PULSE_COUNTER_PCNT_UNIT, PCNT_EVT_H_LIM);
+  if (!isr_service_installed) {
+    if (pcnt_isr_service_install(ESP_INTR_FLAG_IRAM) != ESP_OK) return false;
+    isr_service_installed = true;
+  }
+  pcnt_isr_handler_add(PULSE_COUNTER_PCNT_UNIT, contarVuelta, nullptr);
+
+  pcnt_counter_pause(PULSE_COUNTER_PCNT_UNIT);
+  pcnt_counter_clear(PULSE_COUNTER_PCNT_UNIT);
+  pcnt_intr_enable(PULSE_COUNTER_PCNT_UNIT);
+  pcnt_counter_resume(PULSE_COUNTER_PCNT_UNIT);
+  return true;
+}
+
+static void halDetener() {
+  pcnt_counter_pause(PULSE_COUNTER_PCNT_UNIT);
+  pcnt_intr_disable(PULSE_COUNTER_PCNT_UNIT);
+  pcnt_event_disable(PULSE_COUNTER_PCNT_UNIT, PCNT_EVT_H_LIM);
+  pcnt_isr_handler_remove(PULSE_COUNTER_PCNT_UNIT);
+}
+
+static int16_t halLeer() {
+  int16_t count = 0;
+  pcnt_get_counter_value(PULSE_COUNTER_PCNT_UNIT, &count);
+  return count;
+}
+
+#else
+
+static int16_t host_count = 0;
+static uint32_t host_pending_wraps = 0;
+
+static bool halIniciar(uint8_t pin, uint16_t filter_cycles) {
+  host_count = 0;
+  host_pending_wraps = 0;
+  return true;
+}
+
+static void halDetener() {
+}
+
+static int16_t halLeer() {
+  return host_count;
+}
+
+void pulseCounterHostFlancos(uint32_t count) {
+  if (!counter_active) return;
+  while (count-- > 0) {
+    if (++host_count >= PULSE_COUNTER_LIMIT) {
+      host_count = 0;
+      host_pending_wraps++;
+    }
+  }
+}
+
+void pulseCounterHostAtenderIsr() {
+  while (host_pending_wraps > 0) {
+    host_pending_wraps--;
+    contarVuelta(nullptr);
+  }
+}
+
+#endif
+
+// --- Cuenta extendida a 64 bits ---
+
+bool pulseCounterIniciar(uint8_t pin, uint32_t filter_ns) {
+  pulseCounterDetener();
+
+  uint32_t filter_cycles = filter_ns * PULSE_COUNTER_APB_MHZ / 1000;
+  if (filter_cycles > PULSE_COUNTER_FILTER_MAX) filter_cycles = PULSE_COUNTER_FILTER_MAX;
+
+  pulse_counter_wraps = 0;
+  last_total = 0;
+  counter_active = halIniciar(pin, (uint16_t)filter_cycles);
+  return counter_active;
+}
+
+void pulseCounterDetener() {
+  if (!counter_active) return;
+  halDetener();
+  counter_active = false;
+}
+
+bool pulseCounterActivo() {
+  return counter_active;
+}
+
+uint64_t pulseCounterLeer() {
+  if (!counter_active) return last_total;
+
+  // Vueltas y contador coherentes: repetir si la ISR entra en medio
+  uint32_t wraps;
+  int16_t count;
+  do {
+    wraps = pulse_counter_wraps;
+    count = halLeer();
+  } while (wraps != pulse_counter_wraps);
+
+  uint64_t total = (uint64_t)wraps * PULSE_COUNTER_LIMIT + (uint16_t)count;
+  // El contador ya volvió a 0 pero la ISR aún no ha sumado la vuelta
+  if (total < last_total) total += PULSE_COUNTER_LIMIT;
+  last_total = total;
+  return total;
+}
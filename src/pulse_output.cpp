@@ -0,0 +1,374 @@
+#include "pulse_output.h"
+#include "pulse_telemetry.h"
+#include "edge_heap.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "soc/gpio_struct.h"
+#else
+#define IRAM_ATTR
+#endif
+
+#define PULSE_OUTPUT_RING_MASK (PULSE_OUTPUT_RING_SIZE - 1)
+
+// Estado de un canal. El anillo es SPSC: el loop escribe en head, el motor lee en tail
+struct PulseChannel {
+  uint8_t pin;
+  volatile uint32_t ring[PULSE_OUTPUT_RING_SIZE];
+  volatile uint32_t head;
+  volatile uint32_t tail;
+  volatile bool finished;
+  volatile bool stream_closed;
+  bool pin_high;
+  uint64_t planned_rise_us;       // Flanco planificado del próximo pulso: origen + suma de períodos
+  uint64_t last_planned_rise_us;  // Flanco planificado del último pulso emitido
+  uint64_t next_rise_us;          // Deadline real del próximo flanco de subida
+};
+
+static PulseChannel channels[PULSE_OUTPUT_MAX_CHANNELS];
+static int channel_count = 0;
+static volatile bool output_active = false;
+static volatile PulseCatchupPolicy catchup_policy = (PulseCatchupPolicy)PULSE_OUTPUT_CATCHUP_POLICY;
+static EdgeHeap edge_heap;  // Próximo flanco de cada canal en marcha
+static uint64_t output_start_us = 0;  // Origen común de las líneas de tiempo
+
+volatile PulseOutputChannelStats pulse_output_stats[PULSE_OUTPUT_MAX_CHANNELS];
+volatile uint32_t pulse_output_skew_us = 0;
+volatile uint32_t pulse_output_max_skew_us = 0;
+
+#ifdef ARDUINO
+static hw_timer_t* output_timer = nullptr;
+#else
+PulseOutputHostEdge pulse_output_host_edges[PULSE_OUTPUT_HOST_MAX_EDGES];
+int pulse_output_host_edge_count = 0;
+uint32_t pulse_output_host_latency_us = 0;
+static uint64_t host_now_us = 0;
+#endif
+
+static void IRAM_ATTR escribirPin(int ch, bool high, uint64_t now_us) {
+  uint8_t pin = channels[ch].pin;
+#ifdef ARDUINO
+  // Acceso directo a registros: digitalWrite no es seguro desde la ISR
+  (void)now_us;
+  if (pin < 32) {
+    if (high) GPIO.out_w1ts = (1UL << pin);
+    else GPIO.out_w1tc = (1UL << pin);
+  } else {
+    if (high) GPIO.out1_w1ts.val = (1UL << (pin - 32));
+    else GPIO.out1_w1tc.val = (1UL << (pin - 32));
+  }
+#else
+  (void)pin;
+  if (pulse_output_host_edge_count < PULSE_OUTPUT_HOST_MAX_EDGES) {
+    pulse_output_host_edges[pulse_output_host_edge_count].t_us = now_us;
+    pulse_output_host_edges[pulse_output_host_edge_count].channel = (uint8_t)ch;
+    pulse_output_host_edges[pulse_output_host_edge_count].level = high ? 1 : 0;
+    pulse_output_host_edge_count++;
+  }
+#endif
+  channels[ch].pin_high = high;
+}
+
+// Skew actual: dispersión de los retrasos de los canales que siguen emitiendo
+static void IRAM_ATTR actualizarSkew() {
+  int32_t min_drift = 0;
+  int32_t max_drift = 0;
+  bool any = false;
+  for (int ch = 0; ch < channel_count; ch++) {
+    if (channels[ch].finished || pulse_output_stats[ch].emitted == 0) continue;
+    int32_t drift = pulse_output_stats[ch].drift_us;
+    if (!any || drift < min_drift) min_drift = drift;
+    if (!any || drift > max_drift) max_drift = drift;
+    any = true;
+  }
+  pulse_output_skew_us = (uint32_t)(max_drift - min_drift);
+  if (pulse_output_skew_us > pulse_output_max_skew_us) {
+    pulse_output_max_skew_us = pulse_output_skew_us;
+  }
+}
+
+// Ejecuta el flanco vencido del canal y devuelve el deadline del siguiente (0 = fin).
+// Los flancos de subida se anclan a la línea de tiempo planificada (origen +
+// suma de períodos), no al flanco real anterior: un pulso tardío no desplaza
+// el resto del patrón.
+static uint64_t IRAM_ATTR procesarFlanco(int ch, uint64_t deadline_us, uint64_t now_us) {
+  PulseChannel* channel = &channels[ch];
+  volatile PulseOutputChannelStats* stats = &pulse_output_stats[ch];
+
+  // Fin del pulso HIGH: el siguiente flanco de subida ya está calculado
+  if (channel->pin_high) {
+    escribirPin(ch, false, now_us);
+    return channel->next_rise_us;
+  }
+
+  // Período que sigue a este pulso. Con CATCHUP_SKIP se descartan los pulsos
+  // cuyo sucesor también debería haber salido ya
+  uint32_t period_us;
+  while (true) {
+    if (channel->tail == channel->head) {
+      if (channel->stream_closed) {
+        channel->finished = true;
+        return 0;
+      }
+      stats->underruns++;
+      return now_us + PULSE_OUTPUT_UNDERRUN_RETRY_US;
+    }
+
+    period_us = channel->ring[channel->tail & PULSE_OUTPUT_RING_MASK];
+    channel->tail++;
+
+    if (catchup_policy == CATCHUP_SKIP && now_us >= channel->planned_rise_us + period_us) {
+      channel->planned_rise_us += period_us;
+      stats->skipped++;
+      continue;
+    }
+    break;
+  }
+
+  escribirPin(ch, true, now_us);
+
+  if (stats->emitted > 0) {
+    stats->last_real_us = (uint32_t)(now_us - stats->last_rise_us);
+    stats->last_planned_us = (uint32_t)(channel->planned_rise_us - channel->last_planned_rise_us);
+  }
+  // La telemetría por pulso sigue al canal principal (SENSOR_PIN)
+  if (ch == 0) {
+    pulseTelemetryRegistrar(stats->emitted + 1, stats->last_planned_us, stats->last_real_us, (uint32_t)now_us);
+  }
+  stats->last_error_us = (int32_t)(now_us - deadline_us);
+  stats->drift_us = (int32_t)(now_us - channel->planned_rise_us);
+  if (stats->drift_us > stats->max_drift_us) stats->max_drift_us = stats->drift_us;
+  stats->last_rise_us = now_us;
+  stats->current_period_us = period_us;
+  stats->emitted++;
+  actualizarSkew();
+
+  // Próximo flanco: el planificado, salvo que ya haya pasado
+  channel->last_planned_rise_us = channel->planned_rise_us;
+  channel->planned_rise_us += period_us;
+
+  uint64_t earliest_us = now_us + PULSE_OUTPUT_MIN_GAP_US;
+  if (catchup_policy == CATCHUP_COMPRESS) {
+    // Recuperar el retraso acortando períodos, como mucho hasta el porcentaje mínimo
+    uint64_t compressed_us = now_us + (uint64_t)period_us * PULSE_OUTPUT_COMPRESS_MIN_PERCENT / 100;
+    if (compressed_us > earliest_us) earliest_us = compressed_us;
+  }
+  channel->next_rise_us = channel->planned_rise_us;
+  if (channel->next_rise_us < earliest_us) {
+    channel->next_rise_us = earliest_us;
+  }
+
+  uint32_t high_us = PULSE_HIGH_US;
+  uint32_t interval_us = (uint32_t)(channel->next_rise_us - now_us);
+  if (high_us > interval_us / 2) high_us = interval_us / 2;
+  return now_us + high_us;
+}
+
+// Procesa el flanco de la raíz del heap y re-inserta el siguiente de su canal
+static void IRAM_ATTR atenderFlanco(uint64_t now_us) {
+  EdgeHeapEntry edge = edgeHeapExtraer(&edge_heap);
+  uint64_t next_us = procesarFlanco(edge.channel, edge.deadline_us, now_us);
+  if (next_us != 0) {
+    edgeHeapInsertar(&edge_heap, next_us, edge.channel);
+  }
+  if (edgeHeapVacio(&edge_heap)) output_active = false;
+}
+
+#ifdef ARDUINO
+static void IRAM_ATTR pulseOutputIsr() {
+  while (output_active) {
+    uint64_t now_us = timerRead(output_timer);
+    uint64_t deadline_us = edgeHeapMinimo(&edge_heap).deadline_us;
+    if (deadline_us > now_us + PULSE_OUTPUT_MIN_LEAD_US) break;
+
+    // Flanco inminente: esperar dentro de la ISR en vez de re-armar la alarma
+    while (now_us < deadline_us) now_us = timerRead(output_timer);
+
+    atenderFlanco(now_us);
+  }
+
+  if (output_active) {
+    timerAlarmWrite(output_timer, edgeHeapMinimo(&edge_heap).deadline_us, false);
+    timerAlarmEnable(output_timer);
+  }
+}
+#endif
+
+uint64_t IRAM_ATTR pulseOutputAhoraUs() {
+#ifdef ARDUINO
+  return output_timer ? timerRead(output_timer) : 0;
+#else
+  return host_now_us;
+#endif
+}
+
+void pulseOutputBegin(const uint8_t* pins, int count) {
+  pulseOutputDetener();
+
+  if (count > PULSE_OUTPUT_MAX_CHANNELS) count = PULSE_OUTPUT_MAX_CHANNELS;
+  channel_count = count;
+  for (int ch = 0; ch < channel_count; ch++) {
+    channels[ch].pin = pins[ch];
+#ifdef ARDUINO
+    pinMode(pins[ch], OUTPUT);
+    digitalWrite(pins[ch], LOW);
+#endif
+    channels[ch].pin_high = false;
+  }
+
+#ifdef ARDUINO
+  if (!output_timer) {
+    output_timer = timerBegin(PULSE_OUTPUT_TIMER, 80, true);  // 80 MHz / 80 = 1 µs por tick
+    timerAttachInterrupt(output_timer, pulseOutputIsr, true);
+  }
+#endif
+}
+
+void pulseOutputIniciar() {
+  uint64_t now_us = pulseOutputAhoraUs();
+  uint64_t start_us = now_us + PULSE_OUTPUT_START_DELAY_US;
+  output_start_us = start_us;
+
+  edgeHeapVaciar(&edge_heap);
+  pulse_output_skew_us = 0;
+  pulse_output_max_skew_us = 0;
+
+  for (int ch = 0; ch < channel_count; ch++) {
+    volatile PulseOutputChannelStats* stats = &pulse_output_stats[ch];
+    stats->emitted = 0;
+    stats->underruns = 0;
+    stats->last_rise_us = 0;
+    stats->last_real_us = 0;
+    stats->last_planned_us = 0;
+    stats->last_error_us = 0;
+    stats->current_period_us = 0;
+    stats->skipped = 0;
+    stats->drift_us = 0;
+    stats->max_drift_us = 0;
+
+    channels[ch].finished = false;
+    channels[ch].planned_rise_us = start_us;
+    channels[ch].last_planned_rise_us = start_us;
+    channels[ch].next_rise_us = start_us;
+    escribirPin(ch, false, now_us);
+    edgeHeapInsertar(&edge_heap, start_us, (uint8_t)ch);
+  }
+
+  output_active = !edgeHeapVacio(&edge_heap);
+
+#ifdef ARDUINO
+  if (output_active) {
+    timerAlarmWrite(output_timer, start_us, false);
+    timerAlarmEnable(output_timer);
+  }
+#endif
+}
+
+void pulseOutputDetener() {
+  output_active = false;
+#ifdef ARDUINO
+  if (output_timer) timerAlarmDisable(output_timer);
+#endif
+  edgeHeapVaciar(&edge_heap);
+
+  uint64_t now_us = pulseOutputAhoraUs();
+  for (int ch = 0; ch < channel_count; ch++) {
+    escribirPin(ch, false, now_us);
+    channels[ch].head = 0;
+    channels[ch].tail = 0;
+    channels[ch].stream_closed = false;
+    channels[ch].finished = false;
+  }
+}
+
+bool pulseOutputActivo() {
+  return output_active;
+}
+
+bool pulseOutputTerminado() {
+  if (channel_count == 0) return false;
+  for (int ch = 0; ch < channel_count; ch++) {
+    if (!channels[ch].finished) return false;
+  }
+  return true;
+}
+
+void pulseOutputPoliticaRecuperacion(PulseCatchupPolicy policy) {
+  catchup_policy = policy;
+}
+
+PulseCatchupPolicy pulseOutputObtenerPolitica() {
+  return catchup_policy;
+}
+
+const char* pulseOutputNombrePolitica(PulseCatchupPolicy policy) {
+  switch (policy) {
+    case CATCHUP_EMIT_LATE: return "late";
+    case CATCHUP_SKIP: return "skip";
+    case CATCHUP_COMPRESS: return "compress";
+  }
+  return "?";
+}
+
+int pulseOutputNumCanales() {
+  return channel_count;
+}
+
+bool pulseOutputEncolar(int channel, uint32_t period_us) {
+  if (pulseOutputEspacioLibre(channel) == 0) return false;
+  PulseChannel* output = &channels[channel];
+  output->ring[output->head & PULSE_OUTPUT_RING_MASK] = period_us;
+  output->head++;
+  return true;
+}
+
+int pulseOutputEspacioLibre(int channel) {
+  if (channel < 0 || channel >= channel_count) return 0;
+  return PULSE_OUTPUT_RING_SIZE - (int)(channels[channel].head - channels[channel].tail);
+}
+
+void pulseOutputCerrarFlujo(int channel) {
+  if (channel < 0 || channel >= channel_count) return;
+  channels[channel].stream_closed = true;
+}
+
+bool pulseOutputCanalTerminado(int channel) {
+  if (channel < 0 || channel >= channel_count) return true;
+  return channels[channel].finished;
+}
+
+#ifdef ARDUINO
+void pulseOutputImprimirCanales() {
+  Serial.println("=== CANALES DEL GENERADOR ===");
+  Serial.printf("Recuperación de retrasos: %s\n", pulseOutputNombrePolitica(catchup_policy));
+  Serial.println("Canal  GPIO  pulsos  saltados  underruns  deriva(us)  deriva max(us)  estado");
+  for (int ch = 0; ch < channel_count; ch++) {
+    Serial.printf("%5d  %4d  %6lu  %8lu  %9lu  %10ld  %14ld  %s\n", ch, channels[ch].pin,
+                  (unsigned long)pulse_output_stats[ch].emitted,
+                  (unsigned long)pulse_output_stats[ch].skipped,
+                  (unsigned long)pulse_output_stats[ch].underruns,
+                  (long)pulse_output_stats[ch].drift_us,
+                  (long)pulse_output_stats[ch].max_drift_us,
+                  channels[ch].finished ? "terminado" : (output_active ? "activo" : "parado"));
+  }
+  for (int ch = 0; ch < channel_count; ch++) {
+    if (pulse_output_stats[ch].emitted == 0) continue;
+    // Del origen al último flanco emitido: planificado vs real
+    Serial.printf("Canal %d: duración planificada %.3f s | real %.3f s\n", ch,
+                  (channels[ch].last_planned_rise_us - output_start_us) / 1000000.0,
+                  (pulse_output_stats[ch].last_rise_us - output_start_us) / 1000000.0);
+  }
+  Serial.printf("Skew entre canales: actual %lu us | max %lu us\n",
+                (unsigned long)pulse_output_skew_us, (unsigned long)pulse_output_max_skew_us);
+}
+#else
+void pulseOutputHostAvanzar(uint64_t hasta_us) {
+  while (output_active && edgeHeapMinimo(&edge_heap).deadline_us <= hasta_us) {
+    // La ISR atiende los flancos en serie: el reloj simulado nunca retrocede
+    uint64_t now_us = edgeHeapMinimo(&edge_heap).deadline_us + pulse_output_host_latency_us;
+    if (now_us > host_now_us) host_now_us = now_us;
+    atenderFlanco(host_now_us);
+  }
+  if (host_now_us < hasta_us) host_now_us = hasta_us;
+}
+#endif
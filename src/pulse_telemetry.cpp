@@ -0,0 +1,140 @@
+#include "pulse_telemetry.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+static portMUX_TYPE telemetry_mux = portMUX_INITIALIZER_UNLOCKED;
+#define TELEMETRY_LOCK_ISR() portENTER_CRITICAL_ISR(&telemetry_mux)
+#define TELEMETRY_UNLOCK_ISR() portEXIT_CRITICAL_ISR(&telemetry_mux)
+#define TELEMETRY_LOCK() portENTER_CRITICAL(&telemetry_mux)
+#define TELEMETRY_UNLOCK() portEXIT_CRITICAL(&telemetry_mux)
+#else
+#define IRAM_ATTR
+#define TELEMETRY_LOCK_ISR()
+#define TELEMETRY_UNLOCK_ISR()
+#define TELEMETRY_LOCK()
+#define TELEMETRY_UNLOCK()
+#endif
+
+#define PULSE_TELEMETRY_RING_MASK (PULSE_TELEMETRY_RING_SIZE - 1)
+
+// Límites superiores (exclusivos) de las cubetas de |error|; la última es abierta
+const uint32_t PULSE_TELEMETRY_HIST_LIMITS_US[PULSE_TELEMETRY_HIST_BINS - 1] = {
+  10, 50, 100, 500, 1000, 5000
+};
+
+static PulseTelemetryRecord telemetry_ring[PULSE_TELEMETRY_RING_SIZE];
+static volatile uint32_t telemetry_last_seq = 0;
+static PulseTelemetrySummary telemetry_summary;
+
+void pulseTelemetryReset() {
+  TELEMETRY_LOCK();
+  memset(telemetry_ring, 0, sizeof(telemetry_ring));
+  memset(&telemetry_summary, 0, sizeof(telemetry_summary));
+  telemetry_last_seq = 0;
+  TELEMETRY_UNLOCK();
+}
+
+void IRAM_ATTR pulseTelemetryRegistrar(uint32_t seq, uint32_t planned_us, uint32_t real_us, uint32_t rise_us) {
+  int32_t error_us = (int32_t)(real_us - planned_us);
+  uint32_t abs_error_us = (error_us < 0) ? (uint32_t)(-error_us) : (uint32_t)error_us;
+
+  int bin = 0;
+  while (bin < PULSE_TELEMETRY_HIST_BINS - 1 && abs_error_us >= PULSE_TELEMETRY_HIST_LIMITS_US[bin]) {
+    bin++;
+  }
+
+  TELEMETRY_LOCK_ISR();
+  PulseTelemetryRecord* rec = &telemetry_ring[seq & PULSE_TELEMETRY_RING_MASK];
+  rec->seq = seq;
+  rec->planned_us = planned_us;
+  rec->real_us = real_us;
+  rec->error_us = error_us;
+  rec->rise_us = rise_us;
+  telemetry_last_seq = seq;
+
+  if (seq < 2) {
+    TELEMETRY_UNLOCK_ISR();
+    return;
+  }
+
+  telemetry_summary.count++;
+  telemetry_summary.sum_error_us += error_us;
+  if (abs_error_us > telemetry_summary.max_abs_error_us) {
+    telemetry_summary.max_abs_error_us = abs_error_us;
+  }
+  if (error_us > PULSE_TELEMETRY_LATE_US) {
+    telemetry_summary.late_count++;
+  }
+  telemetry_summary.histogram[bin]++;
+  TELEMETRY_UNLOCK_ISR();
+}
+
+bool pulseTelemetryLeer(uint32_t seq, PulseTelemetryRecord* out) {
+  bool ok = false;
+  TELEMETRY_LOCK();
+  const PulseTelemetryRecord* rec = &telemetry_ring[seq & PULSE_TELEMETRY_RING_MASK];
+  if (seq != 0 && rec->seq == seq) {
+    *out = *rec;
+    ok = true;
+  }
+  TELEMETRY_UNLOCK();
+  return ok;
+}
+
+uint32_t pulseTelemetryUltimoSeq() {
+  return telemetry_last_seq;
+}
+
+void pulseTelemetryObtenerResumen(PulseTelemetrySummary* out) {
+  TELEMETRY_LOCK();
+  *out = telemetry_summary;
+  TELEMETRY_UNLOCK();
+}
+
+#ifdef ARDUINO
+void pulseTelemetryImprimirResumen() {
+  PulseTelemetrySummary summary;
+  pulseTelemetryObtenerResumen(&summary);
+
+  Serial.println("=== TELEMETRÍA GENERADOR ===");
+  if (summary.count == 0) {
+    Serial.println("Sin pulsos registrados");
+    return;
+  }
+
+  Serial.printf("Pulsos: %lu | Error medio: %.1f us | Error max: %lu us | Tardios (>%d us): %lu\n",
+                (unsigned long)summary.count,
+                (double)summary.sum_error_us / summary.count,
+                (unsigned long)summary.max_abs_error_us,
+                PULSE_TELEMETRY_LATE_US,
+                (unsigned long)summary.late_count);
+
+  Serial.println("Histograma |error|:");
+  uint32_t lower_us = 0;
+  for (int i = 0; i < PULSE_TELEMETRY_HIST_BINS; i++) {
+    if (i < PULSE_TELEMETRY_HIST_BINS - 1) {
+      Serial.printf("  %5lu-%5lu us: %lu\n", (unsigned long)lower_us,
+                    (unsigned long)PULSE_TELEMETRY_HIST_LIMITS_US[i] - 1,
+                    (unsigned long)summary.histogram[i]);
+      lower_us = PULSE_TELEMETRY_HIST_LIMITS_US[i];
+    } else {
+      Serial.printf("  >=%lu us: %lu\n", (unsigned long)lower_us, (unsigned long)summary.histogram[i]);
+    }
+  }
+}
+
+void pulseTelemetryVolcar() {
+  uint32_t last_seq = telemetry_last_seq;
+  uint32_t first_seq = (last_seq > PULSE_TELEMETRY_RING_SIZE) ? last_seq - PULSE_TELEMETRY_RING_SIZE + 1 : 1;
+
+  Serial.println("seq,rise_us,planned_us,real_us,error_us");
+  for (uint32_t seq = first_seq; seq <= last_seq; seq++) {
+    PulseTelemetryRecord rec;
+    if (!pulseTelemetryLeer(seq, &rec)) continue;  // Sobrescrito durante el volcado
+    Serial.printf("%lu,%lu,%lu,%lu,%ld\n", (unsigned long)rec.seq, (unsigned long)rec.rise_us,
+                  (unsigned long)rec.planned_us,
+                  (unsigned long)rec.real_us, (long)rec.error_us);
+  }
+}
+#endif
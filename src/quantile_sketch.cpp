@@ -0,0 +1,134 @@
+#include "quantile_sketch.h"
+#include <string.h>
+
+#define SUB_COUNT (1u << QUANTILE_SUB_BITS)
+
+int cuantilesIndice(uint32_t value) {
+  if (value < SUB_COUNT) return (int)value;
+  int msb = 31 - __builtin_clz(value);
+  if (msb >= QUANTILE_MAX_BITS) return QUANTILE_OVERFLOW_BUCKET;
+  // Octava (msb) y los QUANTILE_SUB_BITS bits que siguen al más alto
+  int shift = msb - QUANTILE_SUB_BITS;
+  uint32_t sub = (value >> shift) & (SUB_COUNT - 1);
+  return (int)(SUB_COUNT + (uint32_t)shift * SUB_COUNT + sub);
+}
+
+bool cuantilesRangoCubeta(int index, uint32_t* low, uint32_t* high) {
+  if (index >= QUANTILE_OVERFLOW_BUCKET) {
+    *low = 1u << QUANTILE_MAX_BITS;
+    *high = UINT32_MAX;
+    return false;
+  }
+  if (index < (int)SUB_COUNT) {
+    *low = *high = (uint32_t)index;
+    return true;
+  }
+  int shift = (index - (int)SUB_COUNT) / (int)SUB_COUNT;
+  uint32_t sub = (uint32_t)(index - (int)SUB_COUNT) % SUB_COUNT;
+  *low = (SUB_COUNT + sub) << shift;
+  *high = *low + ((1u << shift) - 1);
+  return true;
+}
+
+static void vaciarSlot(QuantileSketch* sketch, int slot) {
+  memset(sketch->slots[slot], 0, sizeof(sketch->slots[slot]));
+  sketch->slot_count[slot] = 0;
+  sketch->slot_max[slot] = 0;
+}
+
+void cuantilesIniciar(QuantileSketch* sketch, uint32_t window_ms, uint32_t now_ms) {
+  sketch->window_ms = window_ms;
+  sketch->slot_ms = (window_ms + QUANTILE_WINDOW_SLOTS - 1) / QUANTILE_WINDOW_SLOTS;
+  sketch->slot_start_ms = now_ms;
+  sketch->slot = 0;
+  for (int s = 0; s < QUANTILE_WINDOW_SLOTS; s++) {
+    vaciarSlot(sketch, s);
+  }
+  memset(sketch->total, 0, sizeof(sketch->total));
+  sketch->count = 0;
+  sketch->saturated = 0;
+}
+
+// Avanza la ventana hasta now_ms: los sub-histogramas que salen se restan del total
+static void rotarVentana(QuantileSketch* sketch, uint32_t now_ms) {
+  if (sketch->window_ms == 0) return;
+
+  uint32_t steps = (now_ms - sketch->slot_start_ms) / sketch->slot_ms;
+  if (steps == 0) return;
+
+  if (steps >= QUANTILE_WINDOW_SLOTS) {
+    // Más de una ventana sin muestras: todo caducado
+    for (int s = 0; s < QUANTILE_WINDOW_SLOTS; s++) {
+      vaciarSlot(sketch, s);
+    }
+    memset(sketch->total, 0, sizeof(sketch->total));
+    sketch->count = 0;
+  } else {
+    for (uint32_t i = 0; i < steps; i++) {
+      sketch->slot = (sketch->slot + 1) % QUANTILE_WINDOW_SLOTS;
+      uint16_t* old = sketch->slots[sketch->slot];
+      if (sketch->slot_count[sketch->slot] > 0) {
+        for (int b = 0; b < QUANTILE_BUCKETS; b++) {
+          sketch->total[b] -= old[b];
+        }
+        sketch->count -= sketch->slot_count[sketch->slot];
+      }
+      vaciarSlot(sketch, sketch->slot);
+    }
+  }
+  sketch->slot_start_ms += steps * sketch->slot_ms;
+}
+
+void cuantilesAgregar(QuantileSketch* sketch, uint32_t value, uint32_t now_ms) {
+  rotarVentana(sketch, now_ms);
+
+  int index = cuantilesIndice(value);
+  int slot = sketch->slot;
+  if (sketch->window_ms > 0) {
+    if (sketch->slots[slot][index] == UINT16_MAX) {
+      sketch->saturated++;
+      return;
+    }
+    sketch->slots[slot][index]++;
+  }
+  sketch->total[index]++;
+  sketch->count++;
+  sketch->slot_count[slot]++;
+  if (value > sketch->slot_max[slot]) sketch->slot_max[slot] = value;
+}
+
+// Valor representativo de una cubeta: el centro (exacto en las pequeñas).
+// La de desborde no tiene centro: el máximo, que el resumen aplica al recortar.
+static uint32_t centroCubeta(int index) {
+  uint32_t low, high;
+  if (!cuantilesRangoCubeta(index, &low, &high)) return high;
+  return low + (high - low) / 2;
+}
+
+void cuantilesResumen(QuantileSketch* sketch, uint32_t now_ms, QuantileSummary* summary) {
+  rotarVentana(sketch, now_ms);
+
+  summary->count = sketch->count;
+  summary->max = 0;
+  for (int s = 0; s < QUANTILE_WINDOW_SLOTS; s++) {
+    if (sketch->slot_max[s] > summary->max) summary->max = sketch->slot_max[s];
+  }
+  summary->p50 = summary->p90 = summary->p99 = 0;
+  if (sketch->count == 0) return;
+
+  // Rango (1..count) de cada cuantil: el menor valor con al menos q*count por debajo
+  uint32_t rank50 = (uint32_t)(((uint64_t)sketch->count * 50 + 99) / 100);
+  uint32_t rank90 = (uint32_t)(((uint64_t)sketch->count * 90 + 99) / 100);
+  uint32_t rank99 = (uint32_t)(((uint64_t)sketch->count * 99 + 99) / 100);
+  uint32_t seen = 0;
+  for (int b = 0; b < QUANTILE_BUCKETS && seen < rank99; b++) {
+    if (sketch->total[b] == 0) continue;
+    uint32_t before = seen;
+    seen += sketch->total[b];
+    uint32_t value = centroCubeta(b);
+    if (value > summary->max) value = summary->max;
+    if (before < rank50 && seen >= rank50) summary->p50 = value;
+    if (before < rank90 && seen >= rank90) summary->p90 = value;
+    if (seen >= rank99) summary->p99 = value;
+  }
+}
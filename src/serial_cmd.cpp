@@ -0,0 +1,645 @@
+#include "serial_cmd.h"
+#include "pulse_telemetry.h"
+#include "mode_write.h"
+#include "pulse_output.h"
+#include "pattern_storage.h"
+#include "loopback_test.h"
+#include "mode_read.h"
+#include "mode_pressure.h"
+#include "flow_totalizer.h"
+#include "pressure_calibration.h"
+#include "pressure_trigger.h"
+
+static char cmd_buffer[SERIAL_CMD_MAX_LEN];
+static int cmd_length = 0;
+
+static void mostrarAyudaComandos() {
+  Serial.println("Comandos disponibles:");
+  Serial.println("  dump   - Volcar telemetría por pulso del generador (CSV)");
+  Serial.println("  stats  - Resumen de telemetría del generador");
+  Serial.println("  verify - Comparar tablas de patrón (flash) con el generador runtime");
+  Serial.println("  bench  - Coste y tamaño del codec compacto de patrones");
+  Serial.println("  synth  - Velocidad y precisión del sintetizador en punto fijo");
+  Serial.println("  ch     - Canales del generador y skew entre canales");
+  Serial.println("  ch <n> <1-5|9|off> - Patrón del canal adicional n");
+  Serial.println("  ls     - Ficheros de patrón en LittleFS");
+  Serial.println("  load <nombre> - Cargar un fichero de patrón en el canal 0");
+  Serial.printf("  loopback [on|off] - Autotest: GPIO%d captura lo que genera GPIO%d\n",
+                LOOPBACK_CAPTURE_PIN, SENSOR_PIN);
+  Serial.println("  catchup [late|skip|compress] - Recuperación de pulsos tardíos");
+  Serial.println("  periods [on|off] - Modo READ: volcar cada período medido (n,us)");
+  Serial.println("  backend [isr|pcnt|mcpwm] - Modo READ: interrupción, contador hardware o captura hardware de flancos");
+  Serial.println("  timeout [ms] - Modo READ: tiempo sin pulsos para dar el flujo por parado");
+  Serial.println("  events - Modo READ: eventos de flujo detectados (STARTUP/STABLE/TRANSITION/STOP/LEAK)");
+  Serial.println("  check [1-5|9|off|tc] - Modo READ: comparar la captura con un test case / totales esperados");
+  Serial.println("  quant [s|dump] - P50/P90/P99/max de períodos y presión; s = ventana (0 = desde el inicio)");
+  Serial.println("  burst [off|on|<us> [R] [orden]|dump [n]] - Modo PRESSURE: ráfaga I2C 400 kHz con decimador CIC");
+  Serial.println("  cal [add <cuentas> <valor>|here <valor>|del <n>|clear|unit kpa|bar] - Calibración de presión");
+  Serial.println("  trig [level|slope|rate|pulse|win|hyst|single|normal|arm|off|view|zoom|dump] - Modo PRESSURE: captura por disparo");
+  Serial.println("  scale [vis|<s>] - Modo PRESSURE: ventana de la autoescala (lo visible o los últimos s segundos)");
+  Serial.println("  tot [k <pulsos/L>|cal <hz> <factor>|cal clear|save|reset] - Totalizador de volumen");
+  Serial.println("  help   - Mostrar esta ayuda");
+}
+
+// "1".."5" -> TC1-TC5, "9" -> TC9
+static bool parsearTestCase(const char* arg, TestCase* tc) {
+  if (arg[0] >= '1' && arg[0] <= '5' && arg[1] == '\0') {
+    *tc = (TestCase)(TEST_CASE_1 + (arg[0] - '1'));
+    return true;
+  }
+  if (strcmp(arg, "9") == 0) {
+    *tc = TEST_CASE_9;
+    return true;
+  }
+  return false;
+}
+
+// ch [<n> <1-5|9|off>]
+static void comandoCanal(char* args) {
+  char* ch_arg = strtok(args, " ");
+  char* tc_arg = strtok(nullptr, " ");
+  
+  if (!ch_arg) {
+    mostrarCanalesWrite();
+    return;
+  }
+  
+  int ch = atoi(ch_arg);
+  TestCase tc = TEST_CASE_1;
+  bool enabled = tc_arg && strcmp(tc_arg, "off") != 0;
+  if (!tc_arg || (enabled && !parsearTestCase(tc_arg, &tc)) ||
+      !configurarCanalWrite(ch, enabled, tc)) {
+    Serial.printf("Uso: ch <1-%d> <1-5|9|off>\n", WRITE_CHANNEL_COUNT - 1);
+    return;
+  }
+  mostrarCanalesWrite();
+}
+
+// catchup [late|skip|compress]
+static void comandoRecuperacion(char* args) {
+  char* policy_arg = strtok(args, " ");
+  
+  if (policy_arg) {
+    if (strcmp(policy_arg, "late") == 0) {
+      pulseOutputPoliticaRecuperacion(CATCHUP_EMIT_LATE);
+    } else if (strcmp(policy_arg, "skip") == 0) {
+      pulseOutputPoliticaRecuperacion(CATCHUP_SKIP);
+    } else if (strcmp(policy_arg, "compress") == 0) {
+      pulseOutputPoliticaRecuperacion(CATCHUP_COMPRESS);
+    } else {
+      Serial.println("Uso: catchup [late|skip|compress]");
+      return;
+    }
+  }
+  Serial.print("Recuperación de retrasos: ");
+  Serial.println(pulseOutputNombrePolitica(pulseOutputObtenerPolitica()));
+}
+
+// loopback [on|off]
+static void comandoLoopback(char* args) {
+  char* arg = strtok(args, " ");
+  
+  if (!arg) {
+    loopbackImprimirInforme();
+    return;
+  }
+  if (strcmp(arg, "on") == 0) {
+    if (current_mode != MODE_WRITE) {
+      Serial.println("'loopback on' solo en modo WRITE");
+      return;
+    }
+    loopbackActivar(true);
+    Serial.printf("Autotest activo: puentear GPIO%d con GPIO%d. Reiniciando patrón...\n",
+                  SENSOR_PIN, LOOPBACK_CAPTURE_PIN);
+    reiniciarReproduccionWrite();
+  } else if (strcmp(arg, "off") == 0) {
+    loopbackActivar(false);
+    Serial.println("Autotest desactivado");
+  } else {
+    Serial.println("Uso: loopback [on|off]");
+  }
+}
+
+// check [1-5|9|off|tc]
+static void comandoVerificar(char* args) {
+  char* arg = strtok(args, " ");
+  TestCase tc;
+  
+  if (!arg) {
+    mostrarVerificacionRead();
+  } else if (strcmp(arg, "tc") == 0) {
+    mostrarTotalesTestCases();
+  } else if (strcmp(arg, "off") == 0) {
+    seleccionarReferenciaRead(false, read_check_tc);
+  } else if (parsearTestCase(arg, &tc)) {
+    seleccionarReferenciaRead(true, tc);
+  } else {
+    Serial.println("Uso: check [1-5|9|off|tc]");
+  }
+}
+
+static void imprimirCuantiles(const char* name, QuantileSketch* sketch, float scale, const char* unit, bool dump) {
+  QuantileSummary summary;
+  cuantilesResumen(sketch, millis(), &summary);
+  Serial.printf("%-9s n=%-7lu P50 %10.2f  P90 %10.2f  P99 %10.2f  max %10.2f %s", name,
+                (unsigned long)summary.count, summary.p50 * scale, summary.p90 * scale,
+                summary.p99 * scale, summary.max * scale, unit);
+  if (sketch->saturated > 0) {
+    Serial.printf("  (%lu muestras fuera por saturación)", (unsigned long)sketch->saturated);
+  }
+  Serial.println();
+  
+  if (dump) {
+    Serial.println("serie,desde,hasta,muestras");
+    for (int b = 0; b < QUANTILE_BUCKETS; b++) {
+      if (sketch->total[b] == 0) continue;
+      uint32_t low, high;
+      if (cuantilesRangoCubeta(b, &low, &high)) {
+        Serial.printf("%s,%lu,%lu,%lu\n", name, (unsigned long)low, (unsigned long)high,
+                      (unsigned long)sketch->total[b]);
+      } else {
+        // Desborde: sin límite superior
+        Serial.printf("%s,%lu,,%lu\n", name, (unsigned long)low, (unsigned long)sketch->total[b]);
+      }
+    }
+  }
+}
+
+// quant [s|dump]
+static void comandoCuantiles(char* args) {
+  char* arg = strtok(args, " ");
+  bool dump = arg && strcmp(arg, "dump") == 0;
+  
+  if (arg && !dump) {
+    char* end;
+    long window_s = strtol(arg, &end, 10);
+    if (*end != '\0' || window_s < 0 || window_s > (long)(QUANTILE_WINDOW_MAX_MS / 1000)) {
+      Serial.printf("Uso: quant [0-%lu|dump]\n", (unsigned long)(QUANTILE_WINDOW_MAX_MS / 1000));
+      return;
+    }
+    quantile_window_ms = (uint32_t)window_s * 1000;
+    cuantilesIniciar(&read_period_sketch, quantile_window_ms, millis());
+    cuantilesIniciar(&pressure_sketch, quantile_window_ms, millis());
+  }
+  
+  if (quantile_window_ms > 0) {
+    Serial.printf("Ventana: %lu s (%d sub-histogramas de %lu ms)\n", (unsigned long)(quantile_window_ms / 1000),
+                  QUANTILE_WINDOW_SLOTS, (unsigned long)read_period_sketch.slot_ms);
+  } else {
+    Serial.println("Ventana: desde el inicio");
+  }
+  imprimirCuantiles("periodo", &read_period_sketch, 0.001f, "ms", dump);
+  imprimirCuantiles("presion", &pressure_sketch, 1.0f, "cuentas", dump);
+}
+
+static void mostrarTotalizador() {
+  uint32_t now_ms = millis();
+  Serial.printf("Total: %.3f L, %llu pulsos (recuperado de %s)\n", totalizadorLitros(),
+                (unsigned long long)totalizer_totals.pulses, totalizadorNombreOrigen(totalizer_stats.source));
+  Serial.printf("Factor K: %.2f pulsos/L, corrección a %.1f Hz: %.4f\n", totalizer_config.k_factor,
+                pulse_frequency, totalizadorFactorCorreccion(pulse_frequency));
+  for (int i = 0; i < totalizer_config.point_count; i++) {
+    Serial.printf("  %8.2f Hz -> x%.4f\n", totalizer_config.point_hz[i], totalizer_config.point_factor[i]);
+  }
+  Serial.printf("NVS: secuencia %lu, %lu escrituras (%lu errores), máx. %d/h, %s",
+                (unsigned long)totalizer_totals.seq, (unsigned long)totalizer_stats.writes,
+                (unsigned long)totalizer_stats.write_errors, TOTALIZER_MAX_WRITES_PER_HOUR,
+                totalizer_stats.dirty ? "cambios pendientes" : "al día");
+  if (totalizer_stats.dirty) {
+    Serial.printf(", próxima escritura en %lu s", (unsigned long)(totalizadorEsperaEscrituraMs(now_ms) / 1000));
+  }
+  Serial.println();
+}
+
+// tot [k <pulsos/L>|cal <hz> <factor>|cal clear|save|reset]
+static void comandoTotalizador(char* args) {
+  char* arg = strtok(args, " ");
+  
+  if (!arg) {
+    // Solo informe
+  } else if (strcmp(arg, "k") == 0) {
+    char* value = strtok(nullptr, " ");
+    if (!value || !totalizadorConfigurarK(atof(value))) {
+      Serial.println("Uso: tot k <pulsos/L> (mayor que 0)");
+      return;
+    }
+  } else if (strcmp(arg, "cal") == 0) {
+    char* hz = strtok(nullptr, " ");
+    char* factor = strtok(nullptr, " ");
+    if (hz && strcmp(hz, "clear") == 0) {
+      totalizadorBorrarCorreccion();
+    } else if (!hz || !factor || !totalizadorPuntoCorreccion(atof(hz), atof(factor))) {
+      Serial.printf("Uso: tot cal <hz> <factor> | tot cal clear (máx. %d puntos)\n", TOTALIZER_MAX_POINTS);
+      return;
+    }
+  } else if (strcmp(arg, "save") == 0) {
+    // Respeta el límite de escrituras: si no toca, se queda pendiente
+    totalizadorServicio(millis());
+  } else if (strcmp(arg, "reset") == 0) {
+    totalizadorPuestaACero();
+  } else {
+    Serial.println("Uso: tot [k <pulsos/L>|cal <hz> <factor>|cal clear|save|reset]");
+    return;
+  }
+  mostrarTotalizador();
+}
+
+// burst [off|on|<us> [R] [orden]|dump [n]]
+static void comandoRafaga(char* args) {
+  char* arg = strtok(args, " ");
+  
+  if (!arg) {
+    // Solo informe
+  } else if (strcmp(arg, "off") == 0) {
+    configurarRafagaPresion(false, 0, 0, 0);
+  } else if (strcmp(arg, "dump") == 0) {
+    char* count = strtok(nullptr, " ");
+    exportarPresion(count ? atoi(count) : PRESSURE_EXPORT_MAX);
+    if (current_mode != MODE_PRESSURE) Serial.println("(se captura al entrar en modo PRESSURE)");
+    return;
+  } else {
+    char* decimation = strtok(nullptr, " ");
+    char* order = strtok(nullptr, " ");
+    uint32_t period_us = (strcmp(arg, "on") == 0) ? pressure_burst_period_us : (uint32_t)atol(arg);
+    if (!configurarRafagaPresion(true, period_us,
+                                 decimation ? atoi(decimation) : pressure_burst_decimation,
+                                 order ? atoi(order) : pressure_burst_cic_order)) {
+      Serial.printf("Uso: burst [off|on|<us >= %d> [R 1-%d] [orden 1-%d]|dump [n]]\n",
+                    PRESSURE_BURST_MIN_PERIOD_US, CIC_MAX_DECIMATION, CIC_MAX_ORDER);
+      return;
+    }
+  }
+  mostrarAdquisicionPresion();
+}
+
+static void mostrarCalibracion() {
+  if (!calibracionPresionActiva()) {
+    Serial.printf("Presión sin calibrar (%d puntos; hacen falta 2). Unidad: %s\n", pressure_calibration.count,
+                  pressure_calibration.unit == PRESSURE_UNIT_BAR ? "bar" : "kPa");
+  } else {
+    Serial.printf("Calibración de presión: %d puntos, unidad %s\n", pressure_calibration.count,
+                  calibracionPresionNombreUnidad());
+  }
+  float pa_per_unit = calibracionPresionPaPorUnidad();
+  for (int i = 0; i < pressure_calibration.count; i++) {
+    Serial.printf("  %d: %lu cuentas -> %.3f\n", i, (unsigned long)pressure_calibration.points[i].raw,
+                  pressure_calibration.points[i].pa / pa_per_unit);
+  }
+  if (!calibracionPresionActiva()) return;
+
+  // Coste por conversión (el mismo cálculo que se aplica a tasa completa)
+  const int runs = 1024;
+  volatile int32_t sink = 0;
+  uint32_t start_us = micros();
+  for (int i = 0; i < runs; i++) {
+    sink += calibracionPresionPa(pressure_last_raw + (uint32_t)i * 16);
+  }
+  uint32_t elapsed_us = micros() - start_us;
+  Serial.printf("Última lectura: %lu cuentas -> %.3f %s | %.0f ns por conversión\n",
+                (unsigned long)pressure_last_raw, calibracionPresionValor(pressure_last_raw),
+                calibracionPresionNombreUnidad(), elapsed_us * 1000.0f / runs);
+}
+
+// cal [add <cuentas> <valor>|here <valor>|del <n>|clear|unit kpa|bar]
+static void comandoCalibracion(char* args) {
+  char* arg = strtok(args, " ");
+  bool ok = true;
+  
+  if (!arg) {
+    // Solo informe
+  } else if (strcmp(arg, "add") == 0) {
+    char* raw = strtok(nullptr, " ");
+    char* value = strtok(nullptr, " ");
+    ok = raw && value && calibracionPresionAgregar((uint32_t)strtoul(raw, nullptr, 10), atof(value));
+  } else if (strcmp(arg, "here") == 0) {
+    // Punto con la lectura actual (salida del decimador: ya promediada)
+    char* value = strtok(nullptr, " ");
+    ok = value && pressure_last_raw > 0 && calibracionPresionAgregar(pressure_last_raw, atof(value));
+  } else if (strcmp(arg, "del") == 0) {
+    char* index = strtok(nullptr, " ");
+    ok = index && calibracionPresionBorrarPunto(atoi(index));
+  } else if (strcmp(arg, "clear") == 0) {
+    calibracionPresionBorrar();
+  } else if (strcmp(arg, "unit") == 0) {
+    char* unit = strtok(nullptr, " ");
+    if (unit && strcmp(unit, "kpa") == 0) {
+      calibracionPresionUnidad(PRESSURE_UNIT_KPA);
+    } else if (unit && strcmp(unit, "bar") == 0) {
+      calibracionPresionUnidad(PRESSURE_UNIT_BAR);
+    } else {
+      ok = false;
+    }
+  } else {
+    ok = false;
+  }
+  
+  if (!ok) {
+    Serial.printf("Uso: cal [add <cuentas> <valor>|here <valor>|del <n>|clear|unit kpa|bar] "
+                  "(valor en la unidad actual; máx. %d puntos, cuentas distintas hasta %lu, presión no decreciente, máx. %d Pa por cuenta)\n",
+                  PRESSURE_CAL_MAX_POINTS, (unsigned long)PRESSURE_CAL_MAX_RAW, PRESSURE_CAL_MAX_SLOPE);
+    return;
+  }
+  if (arg) reiniciarEscalaPresion();
+  mostrarCalibracion();
+}
+
+// Umbrales del disparo: Pa con calibración (el valor llega en la unidad de pantalla), si no cuentas
+static float unidadesDisparo(float value, bool calibrated) {
+  return calibrated ? value * calibracionPresionPaPorUnidad() : value;
+}
+
+static float valorDisparo(float units, bool calibrated) {
+  return calibrated ? units / calibracionPresionPaPorUnidad() : units;
+}
+
+static void mostrarDisparo() {
+  static const char* state_names[] = {"desarmado", "llenando previas", "armado", "disparado"};
+  static const char* edge_names[] = {"subida", "bajada", "ambos"};
+  const PressureTriggerConfig& config = pressure_trigger_config;
+  const char* unit = config.calibrated ? calibracionPresionNombreUnidad() : "cuentas";
+  
+  Serial.printf("Disparo: %s, %s", state_names[disparoPresionEstado()], nombreDisparoPresion(config.mode));
+  if (config.mode == PRESSURE_TRIGGER_PULSE) {
+    Serial.printf(" (GPIO%d)", PRESSURE_TRIGGER_PIN);
+  } else {
+    Serial.printf(" %s %.4g %s%s, histéresis %.4g", edge_names[config.edge],
+                  valorDisparo(config.threshold, config.calibrated), unit,
+                  config.mode == PRESSURE_TRIGGER_RATE ? "/s" : "", valorDisparo(config.hysteresis, config.calibrated));
+    if (config.mode == PRESSURE_TRIGGER_SLOPE) Serial.printf(" en %d muestras", config.span);
+  }
+  Serial.printf(" | %d antes + %d desde el disparo, %s\n", config.pre, config.post,
+                config.single ? "una captura" : "rearme automático");
+  Serial.printf("Disparos %lu, pulsos %lu (%lu sin armar, %lu perdidos)\n",
+                (unsigned long)pressure_trigger_stats.triggers, (unsigned long)pressure_trigger_stats.pulses,
+                (unsigned long)pressure_trigger_stats.pulses_ignored,
+                (unsigned long)pressure_trigger_stats.pulse_overflows);
+  for (int age = 0; age < PRESSURE_CAPTURE_SLOTS; age++) {
+    const PressureCapture* capture = disparoPresionCaptura(age);
+    if (!capture) continue;
+    uint32_t span_us = capturaPresionMuestra(capture, capture->length - 1).t_us - capturaPresionMuestra(capture, 0).t_us;
+    Serial.printf("  %d: captura %lu (%s), t_us=%lu, %d muestras, %.1f ms\n", age, (unsigned long)capture->seq,
+                  nombreDisparoPresion(capture->mode), (unsigned long)capture->trigger_t_us, capture->length,
+                  span_us / 1000.0f);
+  }
+}
+
+static bool parsearFlanco(const char* arg, PressureTriggerEdge* edge) {
+  if (!arg || strcmp(arg, "rise") == 0) {
+    *edge = PRESSURE_EDGE_RISE;
+  } else if (strcmp(arg, "fall") == 0) {
+    *edge = PRESSURE_EDGE_FALL;
+  } else if (strcmp(arg, "both") == 0) {
+    *edge = PRESSURE_EDGE_BOTH;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// trig [level <v> [rise|fall|both]|slope <salto> <n> [..]|rate <v/s> [..]|pulse|win <pre> <post>|
+//       hyst <v>|single|normal|arm|off|view [n|off] [zoom]|zoom <1-16>|dump [n]]
+static void comandoDisparo(char* args) {
+  char* arg = strtok(args, " ");
+  PressureTriggerConfig config = pressure_trigger_config;
+  bool calibrated = calibracionPresionActiva();
+  bool reconfigure = true;
+  bool ok = true;
+  
+  if (!arg) {
+    reconfigure = false;
+  } else if (strcmp(arg, "level") == 0 || strcmp(arg, "rate") == 0) {
+    char* value = strtok(nullptr, " ");
+    config.mode = (strcmp(arg, "level") == 0) ? PRESSURE_TRIGGER_LEVEL : PRESSURE_TRIGGER_RATE;
+    ok = value && parsearFlanco(strtok(nullptr, " "), &config.edge);
+    if (ok) config.threshold = unidadesDisparo(atof(value), calibrated);
+  } else if (strcmp(arg, "slope") == 0) {
+    char* value = strtok(nullptr, " ");
+    char* span = strtok(nullptr, " ");
+    config.mode = PRESSURE_TRIGGER_SLOPE;
+    ok = value && span && parsearFlanco(strtok(nullptr, " "), &config.edge);
+    if (ok) {
+      config.threshold = unidadesDisparo(atof(value), calibrated);
+      config.span = atoi(span);
+    }
+  } else if (strcmp(arg, "pulse") == 0) {
+    config.mode = PRESSURE_TRIGGER_PULSE;
+  } else if (strcmp(arg, "win") == 0) {
+    char* pre = strtok(nullptr, " ");
+    char* post = strtok(nullptr, " ");
+    ok = pre && post;
+    if (ok) {
+      config.pre = atoi(pre);
+      config.post = atoi(post);
+    }
+  } else if (strcmp(arg, "hyst") == 0) {
+    char* value = strtok(nullptr, " ");
+    ok = value != nullptr;
+    // La histéresis sigue las unidades de los umbrales ya configurados
+    if (ok) config.hysteresis = unidadesDisparo(atof(value), config.calibrated);
+  } else if (strcmp(arg, "single") == 0 || strcmp(arg, "normal") == 0) {
+    config.single = (strcmp(arg, "single") == 0);
+  } else if (strcmp(arg, "arm") == 0) {
+    // Rearma con la misma configuración
+  } else if (strcmp(arg, "off") == 0) {
+    disparoPresionDetener();
+    reconfigure = false;
+  } else if (strcmp(arg, "view") == 0 || strcmp(arg, "zoom") == 0) {
+    reconfigure = false;
+    int age = (pressure_capture_view >= 0) ? pressure_capture_view : 0;
+    int zoom = pressure_capture_zoom;
+    char* value = strtok(nullptr, " ");
+    if (strcmp(arg, "zoom") == 0) {
+      ok = value != nullptr;
+      if (ok) zoom = atoi(value);
+    } else if (value && strcmp(value, "off") == 0) {
+      age = -1;
+    } else if (value) {
+      age = atoi(value);
+      char* zoom_text = strtok(nullptr, " ");
+      if (zoom_text) zoom = atoi(zoom_text);
+    }
+    if (ok && !verCapturaPresion(age, zoom)) {
+      Serial.printf("Sin esa captura o zoom fuera de 1-%d\n", PRESSURE_CAPTURE_MAX_ZOOM);
+      return;
+    }
+  } else if (strcmp(arg, "dump") == 0) {
+    char* age = strtok(nullptr, " ");
+    if (!volcarCapturaPresion(age ? atoi(age) : 0)) Serial.println("Sin esa captura");
+    return;
+  } else {
+    ok = false;
+  }
+  
+  if (ok && reconfigure) {
+    // Un cambio de calibración deja los umbrales en otras unidades: hay que darlos de nuevo
+    if (config.calibrated != calibrated && config.mode != PRESSURE_TRIGGER_PULSE &&
+        strcmp(arg, "level") != 0 && strcmp(arg, "rate") != 0 && strcmp(arg, "slope") != 0) {
+      Serial.println("La calibración ha cambiado: vuelve a configurar el umbral (trig level|slope|rate)");
+      return;
+    }
+    if (calibrated != config.calibrated) config.hysteresis = 0.0f;
+    ok = disparoPresionConfigurar(config);
+  }
+  if (!ok) {
+    Serial.println("Uso: trig [level <v> [rise|fall|both]|slope <salto> <n> [..]|rate <v/s> [..]|pulse|");
+    Serial.printf("            win <pre> <post>|hyst <v>|single|normal|arm|off|view [n|off] [zoom]|zoom <1-%d>|dump [n]]\n",
+                  PRESSURE_CAPTURE_MAX_ZOOM);
+    Serial.printf("(valores en la unidad de pantalla o en cuentas; pre + post <= %d, salto en 1-%d muestras)\n",
+                  PRESSURE_CAPTURE_MAX, PRESSURE_TRIGGER_SLOPE_MAX);
+    return;
+  }
+  if (current_mode != MODE_PRESSURE && disparoPresionEstado() != PRESSURE_CAPTURE_IDLE) {
+    Serial.println("(dispara en modo PRESSURE)");
+  }
+  mostrarDisparo();
+}
+
+// scale [vis|<s>]
+static void comandoEscala(char* args) {
+  char* arg = strtok(args, " ");
+  
+  if (arg) {
+    uint32_t window_ms = (strcmp(arg, "vis") == 0) ? 0 : (uint32_t)(atof(arg) * 1000.0f);
+    if ((strcmp(arg, "vis") != 0 && window_ms == 0) || !configurarVentanaEscalaPresion(window_ms)) {
+      Serial.printf("Uso: scale [vis|<s>] (ventana de %.3f a %lu s)\n", SLIDING_EXTREMA_BLOCKS / 1000.0f,
+                    (unsigned long)(PRESSURE_SCALE_WINDOW_MAX_MS / 1000));
+      return;
+    }
+  }
+  
+  if (pressure_scale_window_ms == 0) {
+    Serial.printf("Autoescala: últimas %d muestras (lo visible)", GRAPH_WIDTH);
+  } else {
+    Serial.printf("Autoescala: últimos %.1f s", pressure_scale_window_ms / 1000.0f);
+  }
+  Serial.printf(" | escala %.4g-%.4g %s, %lu cambios\n", pressure_min_scale, pressure_max_scale,
+                calibracionPresionNombreUnidad(), (unsigned long)pressure_scale_changes);
+}
+
+// backend [isr|pcnt|mcpwm]
+static void comandoBackend(char* args) {
+  char* arg = strtok(args, " ");
+  
+  if (arg && strcmp(arg, "isr") == 0) {
+    seleccionarBackendRead(READ_BACKEND_ISR);
+  } else if (arg && strcmp(arg, "pcnt") == 0) {
+    seleccionarBackendRead(READ_BACKEND_PCNT);
+  } else if (arg && strcmp(arg, "mcpwm") == 0) {
+    seleccionarBackendRead(READ_BACKEND_MCPWM);
+  } else if (arg) {
+    Serial.println("Uso: backend [isr|pcnt|mcpwm]");
+    return;
+  }
+  Serial.print("Backend READ: ");
+  Serial.println(nombreBackendRead(read_backend));
+}
+
+// timeout [ms]
+static void comandoTimeout(char* args) {
+  char* arg = strtok(args, " ");
+  
+  if (arg) {
+    char* end;
+    long timeout_ms = strtol(arg, &end, 10);
+    if (*end != '\0' || timeout_ms <= 0 || timeout_ms > (long)READ_FLOW_TIMEOUT_MAX_MS) {
+      Serial.printf("Uso: timeout [1-%lu ms]\n", (unsigned long)READ_FLOW_TIMEOUT_MAX_MS);
+      return;
+    }
+    configurarTimeoutFlujoRead((uint32_t)timeout_ms);
+  }
+  Serial.printf("Timeout de flujo READ: %lu ms (mínimo medible %.2f Hz)\n",
+                (unsigned long)read_flow_timeout_ms, 1000.0 / read_flow_timeout_ms);
+}
+
+// periods [on|off]
+static void comandoPeriodos(char* args) {
+  char* arg = strtok(args, " ");
+  
+  if (arg && strcmp(arg, "on") == 0) {
+    read_period_log = true;
+  } else if (arg && strcmp(arg, "off") == 0) {
+    read_period_log = false;
+  } else if (arg) {
+    Serial.println("Uso: periods [on|off]");
+    return;
+  }
+  Serial.printf("Períodos READ: %lu medidos, último %lu us, %lu fragmentos, %lu desbordes, volcado %s\n",
+                read_period_stats.count, (unsigned long)read_period_stats.last_us,
+                read_period_stats.fragments, (unsigned long)read_period_stats.overflows,
+                read_period_log ? "activo" : "inactivo");
+}
+
+static void ejecutarComando(char* cmd) {
+  if (strcmp(cmd, "dump") == 0) {
+    pulseTelemetryVolcar();
+  } else if (strcmp(cmd, "stats") == 0) {
+    pulseTelemetryImprimirResumen();
+  } else if (strcmp(cmd, "verify") == 0) {
+    verificarTablasPatron();
+  } else if (strcmp(cmd, "bench") == 0) {
+    benchmarkCodecPatrones();
+  } else if (strcmp(cmd, "synth") == 0) {
+    benchmarkSintetizador();
+  } else if (strcmp(cmd, "ch") == 0 || strncmp(cmd, "ch ", 3) == 0) {
+    comandoCanal(cmd + 2);
+  } else if (strcmp(cmd, "catchup") == 0 || strncmp(cmd, "catchup ", 8) == 0) {
+    comandoRecuperacion(cmd + 7);
+  } else if (strcmp(cmd, "ls") == 0) {
+    listarPatronesArchivo();
+  } else if (strncmp(cmd, "load ", 5) == 0) {
+    if (current_mode == MODE_WRITE) {
+      cargarPatronArchivo(cmd + 5);
+    } else {
+      Serial.println("'load' solo en modo WRITE");
+    }
+  } else if (strcmp(cmd, "loopback") == 0 || strncmp(cmd, "loopback ", 9) == 0) {
+    comandoLoopback(cmd + 8);
+  } else if (strcmp(cmd, "periods") == 0 || strncmp(cmd, "periods ", 8) == 0) {
+    comandoPeriodos(cmd + 7);
+  } else if (strcmp(cmd, "backend") == 0 || strncmp(cmd, "backend ", 8) == 0) {
+    comandoBackend(cmd + 7);
+  } else if (strcmp(cmd, "check") == 0 || strncmp(cmd, "check ", 6) == 0) {
+    comandoVerificar(cmd + 5);
+  } else if (strcmp(cmd, "quant") == 0 || strncmp(cmd, "quant ", 6) == 0) {
+    comandoCuantiles(cmd + 5);
+  } else if (strcmp(cmd, "events") == 0) {
+    mostrarEventosRead();
+  } else if (strcmp(cmd, "timeout") == 0 || strncmp(cmd, "timeout ", 8) == 0) {
+    comandoTimeout(cmd + 7);
+  } else if (strcmp(cmd, "burst") == 0 || strncmp(cmd, "burst ", 6) == 0) {
+    comandoRafaga(cmd + 5);
+  } else if (strcmp(cmd, "cal") == 0 || strncmp(cmd, "cal ", 4) == 0) {
+    comandoCalibracion(cmd + 3);
+  } else if (strcmp(cmd, "trig") == 0 || strncmp(cmd, "trig ", 5) == 0) {
+    comandoDisparo(cmd + 4);
+  } else if (strcmp(cmd, "scale") == 0 || strncmp(cmd, "scale ", 6) == 0) {
+    comandoEscala(cmd + 5);
+  } else if (strcmp(cmd, "tot") == 0 || strncmp(cmd, "tot ", 4) == 0) {
+    comandoTotalizador(cmd + 3);
+  } else if (strcmp(cmd, "help") == 0) {
+    mostrarAyudaComandos();
+  } else {
+    Serial.print("Comando desconocido: ");
+    Serial.println(cmd);
+    mostrarAyudaComandos();
+  }
+}
+
+void procesarComandosSerial() {
+  // Lectura no bloqueante: solo lo que ya está en el buffer UART
+  while (Serial.available() > 0) {
+    char c = (char)Serial.read();
+    
+    if (c == '\r') continue;
+    
+    if (c == '\n') {
+      cmd_buffer[cmd_length] = '\0';
+      if (cmd_length > 0) {
+        ejecutarComando(cmd_buffer);
+      }
+      cmd_length = 0;
+    } else if (cmd_length < SERIAL_CMD_MAX_LEN - 1) {
+      cmd_buffer[cmd_length++] = c;
+    }
+  }
+}
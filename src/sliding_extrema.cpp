@@ -0,0 +1,119 @@
+#include "sliding_extrema.h"
+
+static ExtremaEntry* colaFrente(ExtremaQueue* queue) {
+  return &queue->entries[queue->head];
+}
+
+static ExtremaEntry* colaFondo(ExtremaQueue* queue) {
+  return &queue->entries[(queue->head + queue->count - 1) % SLIDING_EXTREMA_CAPACITY];
+}
+
+static void colaSacarFrente(ExtremaQueue* queue) {
+  queue->head = (queue->head + 1) % SLIDING_EXTREMA_CAPACITY;
+  queue->count--;
+}
+
+// Saca por detrás los valores que value deja sin posibilidad de ser extremo
+// (keep_greater: cola del máximo) y lo añade al final
+static void colaInsertar(ExtremaQueue* queue, float value, uint32_t stamp, bool keep_greater) {
+  while (queue->count > 0) {
+    float back = colaFondo(queue)->value;
+    if (keep_greater ? (back > value) : (back < value)) break;
+    queue->count--;
+  }
+  // Con la capacidad validada no se llena; por si acaso, se pierde el más viejo
+  if (queue->count == SLIDING_EXTREMA_CAPACITY) colaSacarFrente(queue);
+  queue->count++;
+  ExtremaEntry* entry = colaFondo(queue);
+  entry->value = value;
+  entry->stamp = stamp;
+}
+
+static bool caducado(const SlidingExtrema* ext, uint32_t stamp, uint32_t now_ms) {
+  if (ext->by_time) return now_ms - stamp >= ext->window + ext->block_ms;
+  return ext->samples - stamp >= ext->window;
+}
+
+static void colaCaducar(const SlidingExtrema* ext, ExtremaQueue* queue, uint32_t now_ms) {
+  while (queue->count > 0 && caducado(ext, colaFrente(queue)->stamp, now_ms)) {
+    colaSacarFrente(queue);
+  }
+}
+
+void extremosVaciar(SlidingExtrema* ext) {
+  ext->samples = 0;
+  ext->max_queue.head = 0;
+  ext->max_queue.count = 0;
+  ext->min_queue.head = 0;
+  ext->min_queue.count = 0;
+  ext->block_open = false;
+}
+
+bool extremosIniciarMuestras(SlidingExtrema* ext, uint32_t window_samples) {
+  if (window_samples < 1 || window_samples > SLIDING_EXTREMA_CAPACITY) return false;
+  ext->by_time = false;
+  ext->window = window_samples;
+  ext->block_ms = 0;
+  extremosVaciar(ext);
+  return true;
+}
+
+bool extremosIniciarTiempo(SlidingExtrema* ext, uint32_t window_ms) {
+  if (window_ms < SLIDING_EXTREMA_BLOCKS) return false;
+  ext->by_time = true;
+  ext->window = window_ms;
+  ext->block_ms = window_ms / SLIDING_EXTREMA_BLOCKS;
+  extremosVaciar(ext);
+  return true;
+}
+
+void extremosAgregar(SlidingExtrema* ext, float value, uint32_t now_ms) {
+  ext->samples++;
+
+  if (!ext->by_time) {
+    // Sello = número de la muestra (1, 2, ...)
+    colaInsertar(&ext->max_queue, value, ext->samples, true);
+    colaInsertar(&ext->min_queue, value, ext->samples, false);
+    colaCaducar(ext, &ext->max_queue, now_ms);
+    colaCaducar(ext, &ext->min_queue, now_ms);
+    return;
+  }
+
+  if (ext->block_open && now_ms - ext->block_start < ext->block_ms) {
+    if (value > ext->block_max) ext->block_max = value;
+    if (value < ext->block_min) ext->block_min = value;
+    return;
+  }
+
+  // Bloque cerrado: pasa a las colas como una sola entrada
+  if (ext->block_open) {
+    colaInsertar(&ext->max_queue, ext->block_max, ext->block_start, true);
+    colaInsertar(&ext->min_queue, ext->block_min, ext->block_start, false);
+  }
+  colaCaducar(ext, &ext->max_queue, now_ms);
+  colaCaducar(ext, &ext->min_queue, now_ms);
+  ext->block_open = true;
+  ext->block_start = now_ms;
+  ext->block_min = value;
+  ext->block_max = value;
+}
+
+bool extremosLeer(SlidingExtrema* ext, uint32_t now_ms, float* min_value, float* max_value) {
+  if (ext->by_time) {
+    colaCaducar(ext, &ext->max_queue, now_ms);
+    colaCaducar(ext, &ext->min_queue, now_ms);
+  }
+
+  bool found = false;
+  if (ext->max_queue.count > 0) {
+    *max_value = colaFrente(&ext->max_queue)->value;
+    *min_value = colaFrente(&ext->min_queue)->value;
+    found = true;
+  }
+  if (ext->by_time && ext->block_open && !caducado(ext, ext->block_start, now_ms)) {
+    if (!found || ext->block_max > *max_value) *max_value = ext->block_max;
+    if (!found || ext->block_min < *min_value) *min_value = ext->block_min;
+    found = true;
+  }
+  return found;
+}
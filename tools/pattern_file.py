@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""Ficheros de patrón (.pat) del generador: crear, validar y volcar.
+
+Mismo formato que include/pattern_file.h (el firmware valida con el mismo
+criterio). Uso:
+
+  pattern_file.py encode-periods periodos.txt salida.pat [--ms]
+      Un período por línea (µs enteros, o ms con --ms). Líneas '#' ignoradas.
+  pattern_file.py encode-phases fases.json salida.pat
+      [{"type": "transition"|"stable", "start_ms": 75, "end_ms": 43,
+        "pulses": 4, "jitter": 3.0, "jitter_type": "uniform"|"gaussian"}, ...]
+  pattern_file.py validate fichero.pat [...]
+  pattern_file.py dump fichero.pat
+
+Los .pat se suben a LittleFS en /patterns (carpeta data/patterns del proyecto,
+'pio run -t uploadfs') y se cargan con el comando serie 'load <nombre>'.
+"""
+
+import json
+import math
+import struct
+import sys
+import zlib
+
+MAGIC = b"PPAT"
+VERSION = 1
+HEADER = struct.Struct("<4sBBHIII")   # 20 bytes
+PHASE = struct.Struct("<BffIf")        # 17 bytes
+KIND_PERIODS = 0
+KIND_PHASES = 1
+MAX_PHASES = 32
+MAX_PULSES = 1000000                  # PATTERN_FILE_MAX_PULSES: pulsos de un fichero de fases
+PHASE_TYPES = {"transition": 0, "stable": 1}
+PHASE_GAUSSIAN = 0x80
+
+
+class PatternFileError(Exception):
+    pass
+
+
+def zigzag(value):
+    return ((value << 1) ^ (value >> 31)) & 0xFFFFFFFF
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def encode_periods(periods_us):
+    out = bytearray()
+    previous = 0
+    for period in periods_us:
+        if not 0 < period < 2**31:
+            raise PatternFileError("período fuera de rango: %r" % period)
+        value = zigzag(period - previous)
+        while value >= 0x80:
+            out.append((value & 0x7F) | 0x80)
+            value >>= 7
+        out.append(value)
+        previous = period
+    return bytes(out)
+
+
+def decode_periods(payload, count):
+    periods = []
+    pos = 0
+    previous = 0
+    for _ in range(count):
+        value = 0
+        shift = 0
+        while True:
+            if pos >= len(payload) or shift > 28:
+                raise PatternFileError("varint corrupto en el byte %d" % pos)
+            byte = payload[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                break
+        previous = (previous + unzigzag(value)) & 0xFFFFFFFF
+        if previous == 0:
+            raise PatternFileError("período nulo en el pulso %d" % (len(periods) + 1))
+        periods.append(previous)
+    if pos != len(payload):
+        raise PatternFileError("%d bytes sobrantes en el payload" % (len(payload) - pos))
+    return periods
+
+
+def f32(value):
+    """Redondeo a float de 32 bits, para comparar como el firmware."""
+    try:
+        return struct.unpack("<f", struct.pack("<f", value))[0]
+    except OverflowError:
+        return math.copysign(math.inf, value)
+
+
+def phase_valid(phase_type, start, end, jitter):
+    # Mismo criterio que patternFileAbrir (NaN incluido): tempos por debajo
+    # de 4e9 µs y el período más corto posible (tempo menor menos el jitter
+    # máximo, ±1 o ±1.73 veces el %) de al menos 1 µs
+    gaussian = phase_type & PHASE_GAUSSIAN
+    jitter_max = f32(jitter * f32(1.7320508 if gaussian else 1.0))
+    min_us = f32(f32(min(start, end) * 1000.0) * f32(1.0 - f32(jitter_max / 100.0)))
+    return phase_type & ~PHASE_GAUSSIAN in PHASE_TYPES.values() and \
+        f32(start * 1000.0) < 4.0e9 and f32(end * 1000.0) < 4.0e9 and jitter >= 0 and min_us >= 1.0
+
+
+def build_file(kind, count, payload):
+    header = HEADER.pack(MAGIC, VERSION, kind, 0, count, len(payload), zlib.crc32(payload))
+    return header + payload
+
+
+def parse_file(data):
+    """Devuelve (kind, periods_us o lista de fases). Lanza PatternFileError."""
+    if len(data) < HEADER.size:
+        raise PatternFileError("truncado (sin cabecera)")
+    magic, version, kind, _, count, payload_size, crc = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise PatternFileError("no es un fichero de patrón")
+    if version != VERSION:
+        raise PatternFileError("versión no soportada: %d" % version)
+    payload = data[HEADER.size:]
+    if len(payload) != payload_size:
+        raise PatternFileError("payload de %d bytes, cabecera dice %d" % (len(payload), payload_size))
+    if zlib.crc32(payload) != crc:
+        raise PatternFileError("CRC incorrecto")
+
+    if kind == KIND_PERIODS:
+        if not count <= payload_size <= count * 5:
+            raise PatternFileError("tamaño incoherente con %d períodos" % count)
+        return kind, decode_periods(payload, count)
+
+    if kind == KIND_PHASES:
+        if count > MAX_PHASES or payload_size != count * PHASE.size:
+            raise PatternFileError("tamaño incoherente con %d fases" % count)
+        phases = []
+        total_pulses = 0
+        for i in range(count):
+            phase_type, start, end, pulses, jitter = PHASE.unpack_from(payload, i * PHASE.size)
+            total_pulses += pulses
+            if total_pulses > MAX_PULSES:
+                raise PatternFileError("más de %d pulsos en total" % MAX_PULSES)
+            if not phase_valid(phase_type, start, end, jitter):
+                raise PatternFileError("fase %d inválida" % (i + 1))
+            phases.append((phase_type, start, end, pulses, jitter))
+        return kind, phases
+
+    raise PatternFileError("tipo desconocido: %d" % kind)
+
+
+def cmd_encode_periods(args):
+    scale = 1000.0 if "--ms" in args else 1.0
+    paths = [a for a in args if a != "--ms"]
+    periods = []
+    with open(paths[0]) as f:
+        for line in f:
+            line = line.split("#")[0].strip()
+            if line:
+                periods.append(int(round(float(line) * scale)))
+    data = build_file(KIND_PERIODS, len(periods), encode_periods(periods))
+    with open(paths[1], "wb") as f:
+        f.write(data)
+    print("%s: %d períodos, %d bytes (%.2f B/pulso)" % (paths[1], len(periods), len(data),
+                                                        len(data) / max(len(periods), 1)))
+
+
+def cmd_encode_phases(args):
+    with open(args[0]) as f:
+        phases = json.load(f)
+    payload = b"".join(PHASE.pack(PHASE_TYPES[p["type"]] |
+                                  (PHASE_GAUSSIAN if p.get("jitter_type") == "gaussian" else 0),
+                                  p["start_ms"], p.get("end_ms", p["start_ms"]),
+                                  p["pulses"], p.get("jitter", 0.0)) for p in phases)
+    data = build_file(KIND_PHASES, len(phases), payload)
+    parse_file(data)
+    with open(args[1], "wb") as f:
+        f.write(data)
+    print("%s: %d fases, %d pulsos, %d bytes" % (args[1], len(phases),
+                                                 sum(p["pulses"] for p in phases), len(data)))
+
+
+def cmd_validate(args):
+    ok = True
+    for path in args:
+        with open(path, "rb") as f:
+            data = f.read()
+        try:
+            kind, content = parse_file(data)
+        except PatternFileError as e:
+            print("%s: ERROR %s" % (path, e))
+            ok = False
+            continue
+        if kind == KIND_PERIODS:
+            print("%s: OK períodos, %d pulsos, %.1f s" % (path, len(content), sum(content) / 1e6))
+        else:
+            print("%s: OK fases, %d fases, %d pulsos" % (path, len(content), sum(p[3] for p in content)))
+    return 0 if ok else 1
+
+
+def cmd_dump(args):
+    with open(args[0], "rb") as f:
+        kind, content = parse_file(f.read())
+    if kind == KIND_PERIODS:
+        for period in content:
+            print(period)
+    else:
+        names = {v: k for k, v in PHASE_TYPES.items()}
+        for phase_type, start, end, pulses, jitter in content:
+            print("%-10s %8.3f ms -> %8.3f ms  %6d pulsos  jitter %.1f%% %s" %
+                  (names[phase_type & ~PHASE_GAUSSIAN], start, end, pulses, jitter,
+                   "gaussiano" if phase_type & PHASE_GAUSSIAN else "uniforme"))
+
+
+COMMANDS = {
+    "encode-periods": (cmd_encode_periods, 2),
+    "encode-phases": (cmd_encode_phases, 2),
+    "validate": (cmd_validate, 1),
+    "dump": (cmd_dump, 1),
+}
+
+
+def main(argv):
+    if len(argv) < 2 or argv[1] not in COMMANDS or len(argv) - 2 < COMMANDS[argv[1]][1]:
+        print(__doc__)
+        return 2
+    return COMMANDS[argv[1]][0](argv[2:]) or 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))